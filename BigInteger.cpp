@@ -1,8 +1,9 @@
-
 #include "BigInteger.h"
+#include "BigIntegerInternal.h"
 #include <algorithm>
+#include <stdexcept>
 
-bool is_numeric(const std::string& s) 
+bool is_numeric(const std::string& s)
 {
     if(!s.empty() && s[0] == '-')
     {
@@ -11,6 +12,23 @@ bool is_numeric(const std::string& s)
     return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit);
 }
 
+static int compare_magnitude(const LimbVector& a, const LimbVector& b)
+{
+    return bigint_detail::cmp(a.data(), a.size(), b.data(), b.size());
+}
+
+void BigInteger::normalize()
+{
+    while (number.size() > 1 && number.back() == 0)
+    {
+        number.pop_back();
+    }
+    if (number.size() == 1 && number[0] == 0)
+    {
+        negative = false;
+    }
+}
+
 bool BigInteger::is_negative() const
 {
     return negative;
@@ -18,147 +36,154 @@ bool BigInteger::is_negative() const
 
 bool BigInteger::is_positive() const
 {
-    return !negative && number != "0" && !number.empty();
+    return !negative && !number.empty() && (number.size() > 1 || number[0] != 0);
 }
 
-std::string add(const std::string& a, const std::string& b) 
+// Magnitudes of at most two limbs go through native 128-bit arithmetic, so
+// small values never leave LimbVector's inline storage.
+static bigint_detail::dlimb_t to_dlimb(const LimbVector& a)
 {
-    std::string result;
-    int i = a.length() - 1;
-    int j = b.length() - 1;
-    int carry = 0;
-    while (i >= 0 || j >= 0 || carry) 
+    bigint_detail::dlimb_t value = a[0];
+    if (a.size() > 1)
     {
-        int digit1 = (i >= 0) ? a[i--] - '0' : 0;
-        int digit2 = (j >= 0) ? b[j--] - '0' : 0;
-        int sum = digit1 + digit2 + carry;
-        result.push_back((sum % 10) + '0');
-        carry = sum / 10;
+        value |= static_cast<bigint_detail::dlimb_t>(a[1]) << 64;
     }
-    std::reverse(result.begin(), result.end());
-    return result;
+    return value;
 }
 
-std::string subtract(const std::string& a, const std::string& b) 
+static void assign_dlimb(LimbVector& a, bigint_detail::dlimb_t value)
 {
-    std::vector<int> result(a.length());
-    
-    // Convert strings to digits
-    for (unsigned int i = 0; i < a.length(); i++) 
+    std::uint64_t high = static_cast<std::uint64_t>(value >> 64);
+    a.assign(high ? 2 : 1, 0);
+    a[0] = static_cast<std::uint64_t>(value);
+    if (high)
     {
-        result[i] = a[i] - '0';
+        a[1] = high;
     }
-    
-    // Perform subtraction
-    for (unsigned int i = 0; i < b.length(); i++) 
+}
+
+LimbVector add(const LimbVector& a, const LimbVector& b)
+{
+    const LimbVector& longer = a.size() >= b.size() ? a : b;
+    const LimbVector& shorter = a.size() >= b.size() ? b : a;
+    LimbVector result(longer.size());
+    std::uint64_t carry = bigint_detail::add(result.data(), longer.data(), longer.size(), shorter.data(), shorter.size());
+    if (carry)
     {
-        int idx = a.length() - 1 - i;
-        int digit2 = b[b.length() - 1 - i] - '0';
-        
-        if (result[idx] < digit2) {
-            // Need to borrow
-            int j = idx - 1;
-            while (j >= 0 && result[j] == 0)
-            {
-                result[j] = 9;
-                j--;
-            }
-            if (j >= 0) 
-            {
-                result[j]--;
-            }
-            result[idx] += 10;
-        }
-        result[idx] -= digit2;
+        result.push_back(carry);
     }
-    
-    // Convert back to string, removing leading zeros
-    std::string final;
-    bool leadingZeros = true;
-    for (int digit : result) 
+    return result;
+}
+
+// Requires a >= b.
+LimbVector subtract(const LimbVector& a, const LimbVector& b)
+{
+    LimbVector result(a.size());
+    bigint_detail::sub(result.data(), a.data(), a.size(), b.data(), b.size());
+    result.resize(std::max<std::size_t>(bigint_detail::normalized_size(result.data(), result.size()), 1));
+    return result;
+}
+
+LimbVector multiply(const LimbVector& a, const LimbVector& b)
+{
+    LimbVector result;
+    if (a.size() + b.size() <= 2 * LimbVector::INLINE_CAPACITY)
     {
-        if (digit != 0) leadingZeros = false;
-        if (!leadingZeros || final.length() > 0) 
-        {
-            final += digit + '0';
-        }
+        std::uint64_t product[2 * LimbVector::INLINE_CAPACITY];
+        bigint_detail::mul(product, a.data(), a.size(), b.data(), b.size());
+        std::size_t size = bigint_detail::normalized_size(product, a.size() + b.size());
+        result.assign(product, product + std::max<std::size_t>(size, 1));
+        return result;
     }
-    
-    return final.empty() ? "0" : final;
+    result.resize(a.size() + b.size());
+    bigint_detail::mul(result.data(), a.data(), a.size(), b.data(), b.size());
+    result.resize(std::max<std::size_t>(bigint_detail::normalized_size(result.data(), result.size()), 1));
+    return result;
 }
 
-std::string multiply(const std::string& a, const std::string& b) 
+// Splits a by b (b nonzero) into quotient and remainder magnitudes.
+static void divide_magnitude(const LimbVector& a, const LimbVector& b,
+                             LimbVector& quotient, LimbVector& remainder)
 {
-    std::vector<int> result(a.length() + b.length(), 0);
-    
-    // Multiply each digit
-    for (int i = a.length() - 1; i >= 0; i--) 
+    if (a.size() <= LimbVector::INLINE_CAPACITY && b.size() <= LimbVector::INLINE_CAPACITY)
     {
-        for (int j = b.length() - 1; j >= 0; j--) 
-        {
-            int digit1 = a[i] - '0';
-            int digit2 = b[j] - '0';
-            
-            // Add to existing value at position
-            int pos1 = i + j;
-            int pos2 = i + j + 1;
-            int product = digit1 * digit2 + result[pos2];
-            
-            result[pos2] = product % 10;
-            result[pos1] += product / 10;
-        }
+        bigint_detail::dlimb_t dividend = to_dlimb(a);
+        bigint_detail::dlimb_t divisor = to_dlimb(b);
+        assign_dlimb(quotient, dividend / divisor);
+        assign_dlimb(remainder, dividend % divisor);
+        bigint_detail::note_algorithm(BigIntegerAlgorithm::native);
+        return;
     }
-    
-    // Convert to string, removing leading zeros
-    std::string multiply_result;
-    bool leadingZeros = true;
-    
-    for (int digit : result) 
+    if (compare_magnitude(a, b) < 0)
     {
-        if (digit != 0) 
-        {
-            leadingZeros = false;
-        }
-        if (!leadingZeros) 
-        {
-            multiply_result += (digit + '0');
-        }
+        bigint_detail::note_algorithm(BigIntegerAlgorithm::linear);
+        quotient.assign(1, 0);
+        remainder = a;
+        return;
     }
-    
-    return multiply_result.empty() ? "0" : multiply_result;
+    quotient.assign(a.size() - b.size() + 1, 0);
+    remainder.assign(b.size(), 0);
+    bigint_detail::divrem(quotient.data(), remainder.data(), a.data(), a.size(), b.data(), b.size());
+    quotient.resize(std::max<std::size_t>(bigint_detail::normalized_size(quotient.data(), quotient.size()), 1));
+    remainder.resize(std::max<std::size_t>(bigint_detail::normalized_size(remainder.data(), remainder.size()), 1));
+}
+
+LimbVector divide(const LimbVector& a, const LimbVector& b)
+{
+    LimbVector quotient;
+    LimbVector remainder;
+    divide_magnitude(a, b, quotient, remainder);
+    return quotient;
+}
+
+LimbVector mod(const LimbVector& a, const LimbVector& b)
+{
+    LimbVector quotient;
+    LimbVector remainder;
+    divide_magnitude(a, b, quotient, remainder);
+    return remainder;
 }
 
-BigInteger::BigInteger() 
+BigInteger::BigInteger()
     : number(), negative(false)
 {
 }
 
-BigInteger::BigInteger(const std::string& num) 
+BigInteger::BigInteger(const std::string& num)
 {
-    if (!is_numeric(num)) 
-    {
-        throw std::invalid_argument("Cannot assign non-numeric string to BigInteger");
-    }
-    if (num[0] == '-') 
-    {
-        negative = true;
-        number = num.substr(1);
-    } 
-    else 
-    {
-        negative = false;
-        number = num;
-    }
+    *this = num;
 }
 
-BigInteger::BigInteger(const BigInteger& other) 
+BigInteger::BigInteger(const BigInteger& other)
     : number(other.number), negative(other.negative)
 {
 }
 
-BigInteger& BigInteger::operator=(const BigInteger& other) 
+BigInteger::BigInteger(std::pmr::memory_resource* resource)
+    : number(resource), negative(false)
+{
+}
+
+BigInteger::BigInteger(const BigInteger& other, std::pmr::memory_resource* resource)
+    : number(resource), negative(other.negative)
 {
-    if (this != &other) 
+    number = other.number;
+}
+
+std::pmr::memory_resource* BigInteger::get_memory_resource() const
+{
+    return number.get_memory_resource();
+}
+
+BigInteger::BigInteger(BigInteger&& other) noexcept
+    : number(std::move(other.number)), negative(other.negative)
+{
+    other.negative = false;
+}
+
+BigInteger& BigInteger::operator=(const BigInteger& other)
+{
+    if (this != &other)
     {
         number = other.number;
         negative = other.negative;
@@ -166,172 +191,554 @@ BigInteger& BigInteger::operator=(const BigInteger& other)
     return *this;
 }
 
-BigInteger& BigInteger::operator=(const std::string& num) 
+BigInteger& BigInteger::operator=(BigInteger&& other)
 {
-    if (!is_numeric(num)) 
+    if (this != &other)
     {
-        throw std::invalid_argument("Cannot assign non-numeric string to BigInteger");
+        number = std::move(other.number);
+        negative = other.negative;
+        other.negative = false;
     }
-    if (num[0] == '-') 
+    return *this;
+}
+
+// One past the digits starting at first
+static const char* scan_digits(const char* first, const char* last)
+{
+    while (first != last && *first >= '0' && *first <= '9')
     {
-        negative = true;
-        number = num.substr(1);
-        return *this;
-    } 
-    negative = false;
-    number = num;
+        first++;
+    }
+    return first;
+}
+
+BigInteger& BigInteger::operator=(const std::string& num)
+{
+    // Validated by the same scan that counts the digits, and converted
+    // straight from the string's buffer
+    const char* digits = num.data();
+    const char* last = digits + num.length();
+    const bool minus = digits != last && *digits == '-';
+    if (minus)
+    {
+        digits++;
+    }
+    const char* end = scan_digits(digits, last);
+    if (end == digits || end != last)
+    {
+        throw std::invalid_argument("Cannot assign non-numeric string to BigInteger");
+    }
+    assign_decimal(digits, static_cast<std::size_t>(end - digits), minus);
     return *this;
 }
 
-BigInteger BigInteger::operator-() const 
+std::size_t BigInteger::max_decimal_length() const
 {
     if (number.empty())
     {
-        throw std::invalid_argument("Cannot negate an uninitialized BigInteger");
+        return 0;
+    }
+    // log10(2) < 0.30103, so this never undercounts
+    std::size_t bits = 64 * number.size() - static_cast<std::size_t>(__builtin_clzll(number.back() | 1));
+    return bits * 30103 / 100000 + 1 + (negative ? 1 : 0);
+}
+
+std::string BigInteger::to_string() const
+{
+    std::string result(max_decimal_length(), '\0');
+    std::to_chars_result written = to_chars(&result[0], &result[0] + result.length(), *this);
+    result.resize(static_cast<std::size_t>(written.ptr - result.data()));
+    return result;
+}
+
+std::to_chars_result to_chars(char* first, char* last, const BigInteger& value)
+{
+    if (value.number.empty())
+    {
+        return { first, std::errc() };
+    }
+    bigint_detail::OperationScope scope(BigIntegerOperation::to_decimal, value.number.size());
+    char* out = first;
+    if (value.negative)
+    {
+        if (out == last)
+        {
+            return { last, std::errc::value_too_large };
+        }
+        *out++ = '-';
     }
-    BigInteger result(*this);
-    if (result.number != "0") 
+    if (!bigint_detail::write_decimal(value.number.data(), value.number.size(), out, last))
     {
-        result.negative = !result.negative;
+        return { last, std::errc::value_too_large };
     }
-    return result;
+    return { out, std::errc() };
 }
 
-BigInteger BigInteger::operator+(const BigInteger& other) const 
+std::from_chars_result from_chars(const char* first, const char* last, BigInteger& value)
 {
-    if (number.empty() || other.number.empty()) 
+    const char* digits = first;
+    bool negative = false;
+    if (digits != last && *digits == '-')
     {
-        throw std::invalid_argument("Cannot add uninitialized BigInteger");
+        negative = true;
+        digits++;
     }
-    if (!negative && !other.negative) 
+    const char* end = scan_digits(digits, last);
+    if (end == digits)
     {
-        // Both positive
-        return BigInteger(add(number, other.number));
-    } 
-    else if (negative && other.negative) 
+        return { first, std::errc::invalid_argument };
+    }
+    value.assign_decimal(digits, static_cast<std::size_t>(end - digits), negative);
+    return { end, std::errc() };
+}
+
+void BigInteger::assign_decimal(const char* digits, std::size_t length, bool minus)
+{
+    bigint_detail::OperationScope scope(BigIntegerOperation::from_decimal, length / 19 + 1);
+    const char* end = digits + length;
+
+    // Anything that fits in 128 bits is accumulated natively and stays inline
+    bigint_detail::dlimb_t magnitude = 0;
+    bool fits = length <= 39;
+    for (const char* digit = digits; fits && digit != end; digit++)
     {
-        // Both negative
-        BigInteger result(add(number, other.number));
-        result.negative = true;
-        return result;
-    } 
-    else if (negative && !other.negative) 
+        fits = !__builtin_mul_overflow(magnitude, 10, &magnitude)
+            && !__builtin_add_overflow(magnitude, static_cast<unsigned>(*digit - '0'), &magnitude);
+    }
+    if (fits)
+    {
+        assign_dlimb(number, magnitude);
+        bigint_detail::note_algorithm(BigIntegerAlgorithm::native);
+    }
+    else
     {
-        // This is negative, other is positive
-        if (-*this < other)
+        std::vector<std::uint64_t> parsed = bigint_detail::parse_decimal(digits, length);
+        number.assign(parsed.data(), parsed.data() + parsed.size());
+        if (number.empty())
         {
-            return BigInteger(subtract(other.number, number));
+            number.assign(1, 0);
         }
-        else if (*this == -other)
+    }
+    negative = minus;
+    normalize();
+}
+
+BigInteger BigInteger::operator-() const
+{
+    return -BigInteger(*this);
+}
+
+BigInteger operator-(BigInteger&& value)
+{
+    if (value.number.empty())
+    {
+        throw std::invalid_argument("Cannot negate an uninitialized BigInteger");
+    }
+    value.negative = !value.negative;
+    value.normalize();
+    return std::move(value);
+}
+
+// Adds the signed magnitude to this value in place. The magnitude may be this
+// value's own limbs.
+void BigInteger::add_magnitude(const LimbVector& magnitude, bool magnitude_negative)
+{
+    const std::size_t n = number.size();
+    const std::size_t m = magnitude.size();
+    bigint_detail::note_algorithm(BigIntegerAlgorithm::linear);
+    if (negative == magnitude_negative)
+    {
+        // Same sign: magnitudes add and the sign carries over
+        if (n < m)
         {
-            return BigInteger("0");
+            number.reserve(m + 1);
+            number.resize(m);
         }
-        else 
+        std::uint64_t carry = bigint_detail::add(number.data(), number.data(), number.size(), magnitude.data(), m);
+        if (carry)
         {
-            BigInteger result(subtract(number, other.number));
-            result.negative = true;
-            return result;
+            number.push_back(carry);
         }
-    } 
-    else 
+    }
+    else if (compare_magnitude(number, magnitude) >= 0)
+    {
+        // Opposite signs: the larger magnitude decides the sign
+        bigint_detail::sub(number.data(), number.data(), n, magnitude.data(), m);
+    }
+    else
+    {
+        number.resize(m);
+        bigint_detail::sub_n(number.data(), magnitude.data(), number.data(), m);
+        negative = magnitude_negative;
+    }
+    normalize();
+}
+
+BigInteger& BigInteger::operator+=(const BigInteger& other)
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot add uninitialized BigInteger");
+    }
+    bigint_detail::OperationScope scope(BigIntegerOperation::add, std::max(number.size(), other.number.size()));
+    add_magnitude(other.number, other.negative);
+    return *this;
+}
+
+BigInteger& BigInteger::operator-=(const BigInteger& other)
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot add uninitialized BigInteger");
+    }
+    bigint_detail::OperationScope scope(BigIntegerOperation::subtract, std::max(number.size(), other.number.size()));
+    add_magnitude(other.number, !other.negative);
+    return *this;
+}
+
+BigInteger& BigInteger::operator*=(const BigInteger& other)
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot multiply uninitialized BigInteger");
+    }
+    const std::size_t n = number.size();
+    const std::size_t m = other.number.size();
+    bigint_detail::OperationScope scope(BigIntegerOperation::multiply, std::max(n, m));
+    if (n + m <= 2 * LimbVector::INLINE_CAPACITY)
+    {
+        std::uint64_t product[2 * LimbVector::INLINE_CAPACITY];
+        bigint_detail::mul(product, number.data(), n, other.number.data(), m);
+        std::size_t size = bigint_detail::normalized_size(product, n + m);
+        number.assign(product, product + std::max<std::size_t>(size, 1));
+    }
+    else
+    {
+        // The product cannot overlap its inputs, so it is formed in scratch
+        // and copied back into the limbs, which keep their capacity. Each
+        // call takes its own block, so a product running inside a pool task
+        // that helps out during another multiplication cannot clobber it.
+        bigint_detail::ScratchLimbs product = bigint_detail::scratch(n + m);
+        bigint_detail::mul(product.data(), number.data(), n, other.number.data(), m);
+        const std::size_t size = std::max<std::size_t>(bigint_detail::normalized_size(product.data(), n + m), 1);
+        number.assign(product.data(), product.data() + size);
+    }
+    negative = negative != other.negative;
+    normalize();
+    return *this;
+}
+
+void BigInteger::add_product(const BigInteger& a, const BigInteger& b, bool subtract)
+{
+    if (number.empty() || a.number.empty() || b.number.empty())
+    {
+        throw std::invalid_argument("Cannot multiply uninitialized BigInteger");
+    }
+    const bool product_negative = (a.negative != b.negative) != subtract;
+    const LimbVector& x = a.number.size() >= b.number.size() ? a.number : b.number;
+    const LimbVector& y = a.number.size() >= b.number.size() ? b.number : a.number;
+    const std::size_t xn = x.size();
+    const std::size_t yn = y.size();
+    bigint_detail::OperationScope scope(BigIntegerOperation::multiply_add, std::max(number.size(), xn));
+
+    if (xn + yn <= LimbVector::INLINE_CAPACITY)
+    {
+        std::uint64_t product[LimbVector::INLINE_CAPACITY];
+        bigint_detail::mul(product, x.data(), xn, y.data(), yn);
+        LimbVector magnitude(product, product + std::max<std::size_t>(bigint_detail::normalized_size(product, xn + yn), 1));
+        add_magnitude(magnitude, product_negative);
+        return;
+    }
+    if (this == &a || this == &b || yn >= thresholds().karatsuba)
+    {
+        LimbVector product(bigint_detail::scratch_resource());
+        product.resize(xn + yn);
+        bigint_detail::mul(product.data(), x.data(), xn, y.data(), yn);
+        product.resize(std::max<std::size_t>(bigint_detail::normalized_size(product.data(), xn + yn), 1));
+        add_magnitude(product, product_negative);
+        return;
+    }
+
+    // Schoolbook rows go straight into the limbs. The spare top limb absorbs
+    // every carry; when subtracting, the running value can wrap below zero at
+    // most once, and a final borrow means the result is the two's complement
+    // of the true magnitude.
+    bigint_detail::note_algorithm(BigIntegerAlgorithm::schoolbook);
+    const std::size_t total = std::max(number.size(), xn + yn) + 1;
+    number.resize(total);
+    std::uint64_t* r = number.data();
+    if (negative == product_negative)
     {
-        // This is positive, other is negative
-        if (*this < -other) 
+        for (std::size_t j = 0; j < yn; j++)
         {
-            BigInteger result(subtract(other.number, number));
-            result.negative = true;
-            return result;
-        } 
-        else if (*this == -other) 
+            std::uint64_t carry = bigint_detail::addmul_1(r + j, x.data(), xn, y[j]);
+            bigint_detail::add_1(r + j + xn, r + j + xn, total - j - xn, carry);
+        }
+    }
+    else
+    {
+        bool wrapped = false;
+        for (std::size_t j = 0; j < yn; j++)
         {
-            return BigInteger("0");
-        } 
-        else 
+            std::uint64_t borrow = bigint_detail::submul_1(r + j, x.data(), xn, y[j]);
+            wrapped |= bigint_detail::sub_1(r + j + xn, r + j + xn, total - j - xn, borrow) != 0;
+        }
+        if (wrapped)
         {
-            return BigInteger(subtract(number, other.number));
+            for (std::size_t i = 0; i < total; i++)
+            {
+                r[i] = ~r[i];
+            }
+            bigint_detail::add_1(r, r, total, 1);
+            negative = product_negative;
         }
     }
-    throw std::invalid_argument("Invalid BigInteger state for addition");
+    normalize();
 }
 
-BigInteger BigInteger::operator-(const BigInteger& other) const 
+BigInteger& BigInteger::addmul(const BigInteger& a, const BigInteger& b)
 {
-    return *this + -other;
+    add_product(a, b, false);
+    return *this;
 }
 
-BigInteger BigInteger::operator*(const BigInteger& other) const 
+BigInteger& BigInteger::submul(const BigInteger& a, const BigInteger& b)
 {
-    BigInteger result(multiply(number, other.number));
-    if ((is_positive() && other.is_positive()) || 
-        (is_negative() && other.is_negative()))
-    {
-        return result;
-    }
-    result.negative = true;
-    return result;
+    add_product(a, b, true);
+    return *this;
 }
 
-BigInteger BigInteger::operator/(const BigInteger& other) const 
+// Copies source with room for a carry out of a sum with an other_size-limb
+// operand, so the copy is the only allocation. Values that fit inline stay
+// inline until a carry actually spills them.
+static void copy_with_carry_room(LimbVector& target, const LimbVector& source, std::size_t other_size)
 {
-    // Implement division logic here
-    return BigInteger(); // Placeholder
+    std::size_t size = std::max(source.size(), other_size);
+    if (size > LimbVector::INLINE_CAPACITY)
+    {
+        target.reserve(size + 1);
+    }
+    target = source;
 }
 
-bool BigInteger::operator==(const BigInteger& other) const 
+BigInteger BigInteger::operator+(const BigInteger& other) const
 {
-    if (number.empty() || other.number.empty()) 
+    if (number.empty() || other.number.empty())
     {
-        throw std::invalid_argument("Cannot compare uninitialized BigInteger");
+        throw std::invalid_argument("Cannot add uninitialized BigInteger");
     }
-    return (number == other.number) && (negative == other.negative);
+    BigInteger result;
+    copy_with_carry_room(result.number, number, other.number.size());
+    result.negative = negative;
+    return result += other;
 }
 
-bool BigInteger::operator!=(const BigInteger& other) const 
+BigInteger BigInteger::operator-(const BigInteger& other) const
 {
-    return !(*this == other);
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot add uninitialized BigInteger");
+    }
+    BigInteger result;
+    copy_with_carry_room(result.number, number, other.number.size());
+    result.negative = negative;
+    return result -= other;
 }
 
-bool BigInteger::operator<(const BigInteger& other) const 
+BigInteger BigInteger::operator*(const BigInteger& other) const
 {
-    if (number.empty() || other.number.empty()) 
+    if (number.empty() || other.number.empty())
     {
-        throw std::invalid_argument("Cannot compare uninitialized BigInteger");
+        throw std::invalid_argument("Cannot multiply uninitialized BigInteger");
     }
-    if (negative && !other.negative) 
+    bigint_detail::OperationScope scope(BigIntegerOperation::multiply, std::max(number.size(), other.number.size()));
+    BigInteger result;
+    result.number = multiply(number, other.number);
+    result.negative = negative != other.negative;
+    result.normalize();
+    return result;
+}
+
+BigInteger operator+(BigInteger&& lhs, const BigInteger& rhs)
+{
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+BigInteger operator+(const BigInteger& lhs, BigInteger&& rhs)
+{
+    rhs += lhs;
+    return std::move(rhs);
+}
+
+BigInteger operator+(BigInteger&& lhs, BigInteger&& rhs)
+{
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+BigInteger operator-(BigInteger&& lhs, const BigInteger& rhs)
+{
+    lhs -= rhs;
+    return std::move(lhs);
+}
+
+BigInteger operator-(const BigInteger& lhs, BigInteger&& rhs)
+{
+    // lhs - rhs = -(rhs - lhs)
+    rhs -= lhs;
+    return -std::move(rhs);
+}
+
+BigInteger operator-(BigInteger&& lhs, BigInteger&& rhs)
+{
+    lhs -= rhs;
+    return std::move(lhs);
+}
+
+BigInteger operator*(BigInteger&& lhs, const BigInteger& rhs)
+{
+    lhs *= rhs;
+    return std::move(lhs);
+}
+
+BigInteger operator*(const BigInteger& lhs, BigInteger&& rhs)
+{
+    rhs *= lhs;
+    return std::move(rhs);
+}
+
+BigInteger operator*(BigInteger&& lhs, BigInteger&& rhs)
+{
+    lhs *= rhs;
+    return std::move(lhs);
+}
+
+std::pair<BigInteger, BigInteger> divmod(const BigInteger& dividend, const BigInteger& divisor)
+{
+    if (dividend.number.empty() || divisor.number.empty())
     {
-        return true;
+        throw std::invalid_argument("Cannot divide uninitialized BigInteger");
     }
-    if (!negative && other.negative) 
+    if (!divisor.is_positive() && !divisor.is_negative())
     {
-        return false;
+        throw std::invalid_argument("Cannot divide BigInteger by zero");
     }
-    return number < other.number;
+    bigint_detail::OperationScope scope(BigIntegerOperation::divide, dividend.number.size());
+    std::pair<BigInteger, BigInteger> result;
+    divide_magnitude(dividend.number, divisor.number, result.first.number, result.second.number);
+    result.first.negative = dividend.negative != divisor.negative;
+    result.second.negative = dividend.negative;
+    result.first.normalize();
+    result.second.normalize();
+    return result;
+}
+
+BigInteger BigInteger::operator/(const BigInteger& other) const
+{
+    return divmod(*this, other).first;
 }
 
-bool BigInteger::operator<=(const BigInteger& other) const 
+BigInteger BigInteger::operator%(const BigInteger& other) const
 {
-    return (*this < other || *this == other);
+    return divmod(*this, other).second;
 }
 
-bool BigInteger::operator>(const BigInteger& other) const 
+BigInteger& BigInteger::operator/=(const BigInteger& other)
 {
-    return !(*this <= other);
+    return *this = std::move(divmod(*this, other).first);
 }
 
-bool BigInteger::operator>=(const BigInteger& other) const 
+BigInteger& BigInteger::operator%=(const BigInteger& other)
 {
-    return !(*this < other);
+    return *this = std::move(divmod(*this, other).second);
 }
 
-std::ostream& operator<<(std::ostream& os, const BigInteger& bigInt) 
+int compare(const BigInteger& a, const BigInteger& b)
 {
-    if (bigInt.negative) 
+    if (a.number.empty() || b.number.empty())
     {
-        os << '-';
+        throw std::invalid_argument("Cannot compare uninitialized BigInteger");
     }
-    os << bigInt.number;
-    return os;
+    if (a.negative != b.negative)
+    {
+        return a.negative ? -1 : 1;
+    }
+    const int magnitude = compare_magnitude(a.number, b.number);
+    return a.negative ? -magnitude : magnitude;
 }
 
+bool BigInteger::operator==(const BigInteger& other) const
+{
+    return compare(*this, other) == 0;
+}
 
+bool BigInteger::operator!=(const BigInteger& other) const
+{
+    return compare(*this, other) != 0;
+}
+
+bool BigInteger::operator<(const BigInteger& other) const
+{
+    return compare(*this, other) < 0;
+}
+
+bool BigInteger::operator<=(const BigInteger& other) const
+{
+    return compare(*this, other) <= 0;
+}
+
+bool BigInteger::operator>(const BigInteger& other) const
+{
+    return compare(*this, other) > 0;
+}
+
+bool BigInteger::operator>=(const BigInteger& other) const
+{
+    return compare(*this, other) >= 0;
+}
+
+// Folded 128-bit product, the mixing step of wyhash
+static std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b)
+{
+    const bigint_detail::dlimb_t product = static_cast<bigint_detail::dlimb_t>(a) * b;
+    return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+}
 
+std::size_t BigInteger::hash() const
+{
+    if (number.empty())
+    {
+        throw std::invalid_argument("Cannot hash uninitialized BigInteger");
+    }
+    const std::uint64_t k0 = 0xa0761d6478bd642full;
+    const std::uint64_t k1 = 0xe7037ed1a0b428dbull;
+    const std::uint64_t k2 = 0x8ebc6af09c88c6e3ull;
+    const std::uint64_t k3 = 0x589965cc75374cc3ull;
+    const std::size_t n = number.size();
+    std::uint64_t h = negative ? k3 : k0;
+    std::size_t i = 0;
+    for (; i + 1 < n; i += 2)
+    {
+        h = hash_mix(number[i] ^ k1, number[i + 1] ^ h);
+    }
+    if (i < n)
+    {
+        h = hash_mix(number[i] ^ k1, h ^ k2);
+    }
+    return static_cast<std::size_t>(hash_mix(h ^ n, k0));
+}
+
+std::ostream& operator<<(std::ostream& os, const BigInteger& bigInt)
+{
+    // Anything up to 128 bits fits in the stack buffer
+    char buffer[48];
+    if (bigInt.max_decimal_length() <= sizeof(buffer))
+    {
+        std::to_chars_result written = to_chars(buffer, buffer + sizeof(buffer), bigInt);
+        os.write(buffer, written.ptr - buffer);
+        return os;
+    }
+    os << bigInt.to_string();
+    return os;
+}
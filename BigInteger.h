@@ -1,74 +1,248 @@
+#pragma once
 
+#include <charconv>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <memory_resource>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "BigIntegerStats.h"
+#include "LimbVector.h"
+
+// Operand sizes, in limbs, at which multiplication, division, decimal
+// conversion and gcd switch to the next algorithm, and from which subproducts and
+// transforms are spread across worker threads. The defaults suit a typical
+// x86-64 machine; adjust them through BigInteger::thresholds() before doing
+// arithmetic to tune for another one.
+struct BigIntegerThresholds
+{
+    std::size_t karatsuba = 32;
+    std::size_t toom3 = 256;
+    std::size_t ntt = 4096;
+    std::size_t burnikel_ziegler = 64;
+    std::size_t conversion = 32;
+    std::size_t parallel = 1024;
+    std::size_t half_gcd = 4096;
+};
+
+// How the range aggregates in BigIntegerNumeric.h run: parallel spreads the
+// elements across BigInteger::thread_count() threads.
+enum class BigIntegerExecution
+{
+    sequential,
+    parallel
+};
+
+// What FixedBigInteger (FixedBigInteger.h) does with a result outside its
+// range: checked throws std::invalid_argument, wrapping keeps the result
+// modulo 2^Bits as the built-in integers wrap.
+enum class FixedBigIntegerOverflow
+{
+    checked,
+    wrapping
+};
+
+template<typename Derived>
+class BigIntegerExpression;
+
+template<std::size_t Bits, FixedBigIntegerOverflow Overflow>
+class FixedBigInteger;
+
+class BigInteger;
+class BigIntegerView;
+
+namespace bigint_detail
+{
+    BigInteger sum(const BigInteger* const* values, std::size_t count, BigIntegerExecution execution);
+    BigInteger product(const BigInteger* const* values, std::size_t count, BigIntegerExecution execution);
+    BigInteger dot(const BigInteger* const* a, const BigInteger* const* b, std::size_t count, BigIntegerExecution execution);
+    class GcdReduction;
+    class Roots;
+}
 
 class BigInteger
 {
     private:
-        std::string number;
+        // Magnitude as little-endian 64-bit limbs, inline up to 128 bits. An
+        // empty vector marks an uninitialized BigInteger; zero is stored as a
+        // single zero limb.
+        LimbVector number;
         bool negative = false;
         friend bool is_numeric(const std::string& s);
+        friend class ModContext;
+        friend class BigIntegerView;
+        friend class BigIntegerParser;
+        template<std::size_t Bits, FixedBigIntegerOverflow Overflow>
+        friend class FixedBigInteger;
+        friend class bigint_detail::GcdReduction;
+        friend class bigint_detail::Roots;
+        friend BigInteger bigint_detail::sum(const BigInteger* const* values, std::size_t count, BigIntegerExecution execution);
+        friend BigInteger bigint_detail::product(const BigInteger* const* values, std::size_t count, BigIntegerExecution execution);
+        friend BigInteger bigint_detail::dot(const BigInteger* const* a, const BigInteger* const* b, std::size_t count, BigIntegerExecution execution);
+
+        void normalize();
+        void add_magnitude(const LimbVector& magnitude, bool magnitude_negative);
+        void add_product(const BigInteger& a, const BigInteger& b, bool subtract);
+        // Digits already checked to be 0-9
+        void assign_decimal(const char* digits, std::size_t length, bool minus);
+
+        template<typename T>
+        void assign_integral(const T num)
+        {
+            std::uint64_t magnitude = static_cast<std::uint64_t>(num);
+            negative = false;
+            if constexpr (std::is_signed<T>::value)
+            {
+                if (num < 0)
+                {
+                    negative = true;
+                    magnitude = 0 - magnitude;
+                }
+            }
+            number.assign(1, magnitude);
+        }
 
     public:
         BigInteger();
         BigInteger(const std::string& num);
-        
+
+        // An uninitialized BigInteger whose limbs come from resource, such as
+        // a BigIntegerArena. Assignments and compound operators keep using
+        // it; copies and the results of binary operators use the default
+        // resource.
+        explicit BigInteger(std::pmr::memory_resource* resource);
+        BigInteger(const BigInteger& other, std::pmr::memory_resource* resource);
+
         template<typename T, typename = typename std::enable_if_t<std::is_integral<T>::value>>
         BigInteger(const T num)
         {
-            if (num < 0) 
-            {
-                negative = true;
-                number = std::to_string(-num);
-            } 
-            else 
-            {
-                negative = false;
-                number = std::to_string(num);
-            }
+            assign_integral(num);
+        }
+
+        // Evaluates an expression built with lazy() from BigIntegerExpression.h
+        template<typename Derived>
+        BigInteger(const BigIntegerExpression<Derived>& expression)
+        {
+            expression.derived().evaluate(*this);
         }
 
         BigInteger(const BigInteger& other);
+        BigInteger(BigInteger&& other) noexcept;
         BigInteger& operator=(const BigInteger& other);
+        BigInteger& operator=(BigInteger&& other);
         BigInteger& operator=(const std::string& num);
 
-        template<typename T, typename = typename std::enable_if_t<std::is_integral<T>::value>>
-        BigInteger& operator=(const T num) 
+        template<typename Derived>
+        BigInteger& operator=(const BigIntegerExpression<Derived>& expression)
         {
-            if (num < 0) 
+            // Evaluating in place would overwrite an operand still to be read
+            if (expression.derived().refers_to(this))
             {
-                negative = true;
-                number = std::to_string(-num);
-            }
-            else 
-            {
-                negative = false;
-                number = std::to_string(num);
+                BigInteger result(expression);
+                return *this = std::move(result);
             }
+            expression.derived().evaluate(*this);
             return *this;
         }
 
-        std::string to_string() const 
+        template<typename T, typename = typename std::enable_if_t<std::is_integral<T>::value>>
+        BigInteger& operator=(const T num)
         {
-            return (negative ? "-" : "") + number;
+            assign_integral(num);
+            return *this;
         }
 
+        std::string to_string() const;
+
+        // Upper bound on the characters to_chars() writes for this value,
+        // including the sign.
+        std::size_t max_decimal_length() const;
+
+        static BigIntegerThresholds& thresholds();
+
+        // Threads used by huge multiplications and the divisions and
+        // conversions built on them, the calling thread included. Defaults to
+        // the hardware concurrency; 1 keeps all work on the calling thread.
+        // The result never depends on the count. Must not be changed while
+        // other threads are doing arithmetic.
+        static void set_thread_count(std::size_t count);
+        static std::size_t thread_count();
+
+        // The calling thread's operation statistics since the last reset; all
+        // zero unless built with BIGINTEGER_INSTRUMENTATION (see
+        // BigIntegerStats.h).
+        static BigIntegerStats stats();
+        static void reset_stats();
+
+        std::pmr::memory_resource* get_memory_resource() const;
+
         bool is_negative() const;
 
         bool is_positive() const;
-        
 
+        // Equal values hash equally; mixes every limb, two per step. Used by
+        // std::hash<BigInteger>.
+        std::size_t hash() const;
+
+        // Compound operators update the limbs in place; capacity grows
+        // geometrically, so repeated accumulation stops allocating.
         BigInteger& operator+=(const BigInteger& other);
         BigInteger& operator-=(const BigInteger& other);
         BigInteger& operator*=(const BigInteger& other);
         BigInteger& operator/=(const BigInteger& other);
         BigInteger& operator%=(const BigInteger& other);
+        // Fused multiply-add: *this += a * b, or *this -= a * b for submul,
+        // accumulating the product straight into this value's limbs.
+        BigInteger& addmul(const BigInteger& a, const BigInteger& b);
+        BigInteger& submul(const BigInteger& a, const BigInteger& b);
+
+        // Shifts and bitwise operators act on the infinite two's-complement
+        // form, as the built-in operators do on signed integers: ~x is
+        // -x - 1 and >> rounds toward negative infinity. Shifts move whole
+        // limbs and funnel the remaining bits across limb boundaries.
+        BigInteger& operator<<=(std::size_t bits);
+        BigInteger& operator>>=(std::size_t bits);
+        BigInteger& operator&=(const BigInteger& other);
+        BigInteger& operator|=(const BigInteger& other);
+        BigInteger& operator^=(const BigInteger& other);
+        BigInteger operator<<(std::size_t bits) const;
+        BigInteger operator>>(std::size_t bits) const;
+        BigInteger operator&(const BigInteger& other) const;
+        BigInteger operator|(const BigInteger& other) const;
+        BigInteger operator^(const BigInteger& other) const;
+        BigInteger operator~() const;
+
+        // Bits of the shortest two's-complement form less the sign bit: 0 for
+        // 0 and -1, 8 for 255 and -256.
+        std::size_t bit_length() const;
+        // Set bits, or for a negative value the clear bits, which are finite.
+        std::size_t popcount() const;
+        // Bit index of the two's-complement form; bits above the top repeat
+        // the sign. O(1) apart from finding a negative value's lowest set limb.
+        bool test_bit(std::size_t index) const;
+
         BigInteger operator-() const; // Unary minus
 
         BigInteger operator+(const BigInteger& other) const;
         BigInteger operator-(const BigInteger& other) const;
         BigInteger operator*(const BigInteger& other) const;
         BigInteger operator/(const BigInteger& other) const;
+        BigInteger operator%(const BigInteger& other) const;
+
+        // Overloads taking a temporary reuse its storage for the result
+        friend BigInteger operator-(BigInteger&& value);
+        friend BigInteger operator+(BigInteger&& lhs, const BigInteger& rhs);
+        friend BigInteger operator+(const BigInteger& lhs, BigInteger&& rhs);
+        friend BigInteger operator+(BigInteger&& lhs, BigInteger&& rhs);
+        friend BigInteger operator-(BigInteger&& lhs, const BigInteger& rhs);
+        friend BigInteger operator-(const BigInteger& lhs, BigInteger&& rhs);
+        friend BigInteger operator-(BigInteger&& lhs, BigInteger&& rhs);
+        friend BigInteger operator*(BigInteger&& lhs, const BigInteger& rhs);
+        friend BigInteger operator*(const BigInteger& lhs, BigInteger&& rhs);
+        friend BigInteger operator*(BigInteger&& lhs, BigInteger&& rhs);
 
         bool operator==(const BigInteger& other) const;
         bool operator!=(const BigInteger& other) const;
@@ -77,11 +251,56 @@ class BigInteger
         bool operator>(const BigInteger& other) const;
         bool operator>=(const BigInteger& other) const;
 
+        // -1, 0 or 1 as a is less than, equal to or greater than b. Differing
+        // signs or limb counts decide at once; otherwise the limbs are
+        // scanned from the most significant. The operators above use it.
+        friend int compare(const BigInteger& a, const BigInteger& b);
+
+        // Quotient and remainder in one pass, truncating toward zero like the
+        // built-in integer operators: the remainder takes the dividend's sign.
+        friend std::pair<BigInteger, BigInteger> divmod(const BigInteger& dividend, const BigInteger& divisor);
+
+        // base^exponent mod |modulus|, in [0, |modulus|) whatever the signs of
+        // base and modulus. The exponent must not be negative. Never forms
+        // the full power: odd moduli use Montgomery multiplication, even ones
+        // Barrett reduction.
+        friend BigInteger pow_mod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus);
+
+        // pow_mod for secret exponents and odd moduli: the time taken and the
+        // memory touched depend only on the sizes of the operands, not on the
+        // exponent's bits.
+        friend BigInteger pow_mod_secure(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus);
+
+        // Decimal conversion into and out of caller-supplied buffers, following
+        // the std::to_chars/std::from_chars conventions. from_chars accepts an
+        // optional '-' followed by digits and stops at the first non-digit.
+        friend std::to_chars_result to_chars(char* first, char* last, const BigInteger& value);
+        friend std::from_chars_result from_chars(const char* first, const char* last, BigInteger& value);
+
         friend std::ostream& operator<<(std::ostream& os, const BigInteger& bigInt);
 
-        friend std::string add(const std::string& a, const std::string& b);
-        friend std::string subtract(const std::string& a, const std::string& b);
-        friend std::string multiply(const std::string& a, const std::string& b);
-        friend std::string divide(const std::string& a, const std::string& b);
-        friend std::string mod(const std::string& a, const std::string& b);
-};
\ No newline at end of file
+        // Reads an optional '-' and decimal digits after skipping whitespace
+        // as the stream's flags say, stopping before the first other
+        // character. Digits are converted in blocks as they are read (see
+        // BigIntegerParser.h). Sets failbit, leaving value alone, when no
+        // digits follow.
+        friend std::istream& operator>>(std::istream& is, BigInteger& value);
+
+        friend LimbVector add(const LimbVector& a, const LimbVector& b);
+        friend LimbVector subtract(const LimbVector& a, const LimbVector& b);
+        friend LimbVector multiply(const LimbVector& a, const LimbVector& b);
+        friend LimbVector divide(const LimbVector& a, const LimbVector& b);
+        friend LimbVector mod(const LimbVector& a, const LimbVector& b);
+};
+
+namespace std
+{
+    template <>
+    struct hash<BigInteger>
+    {
+        std::size_t operator()(const BigInteger& value) const
+        {
+            return value.hash();
+        }
+    };
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Monotonic arena for batches of short-lived BigIntegers. Limbs are carved out
+// of large chunks, freeing a single value does nothing, and release() hands
+// the whole batch back at once:
+//
+//     BigIntegerArena arena;
+//     BigInteger total(&arena);
+//     ...
+//     arena.release();
+//
+// Values on the arena must not be used after release() or after the arena is
+// destroyed. An arena is not thread safe.
+class BigIntegerArena : public std::pmr::memory_resource
+{
+    public:
+        explicit BigIntegerArena(std::size_t initial_size = 64 * 1024,
+                                 std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : chunks(initial_size, upstream), used(0)
+        {
+        }
+
+        BigIntegerArena(const BigIntegerArena&) = delete;
+        BigIntegerArena& operator=(const BigIntegerArena&) = delete;
+
+        // Frees every block handed out since the last release.
+        void release()
+        {
+            chunks.release();
+            used = 0;
+        }
+
+        // Bytes handed out since the last release.
+        std::size_t bytes_used() const
+        {
+            return used;
+        }
+
+    private:
+        std::pmr::monotonic_buffer_resource chunks;
+        std::size_t used;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            void* block = chunks.allocate(bytes, alignment);
+            used += bytes;
+            return block;
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override
+        {
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+};
@@ -0,0 +1,250 @@
+#include "BigInteger.h"
+#include "BigIntegerView.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Throughput of every operator across operand sizes given in decimal digits,
+// from a single limb up to ten million digits. `make bench` runs the whole
+// sweep and writes the results to JSON; pass --benchmark_filter to run part.
+
+static std::string random_digits(std::size_t length, std::uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::string digits(length, '0');
+    for (char& digit : digits)
+    {
+        digit = static_cast<char>('0' + rng() % 10);
+    }
+    digits[0] = static_cast<char>('1' + rng() % 9);
+    return digits;
+}
+
+static BigInteger random_value(std::size_t length, std::uint64_t seed)
+{
+    return BigInteger(random_digits(length, seed));
+}
+
+// One limb up to 10^7 digits
+static void balanced_sizes(benchmark::internal::Benchmark* benchmark)
+{
+    for (long digits : { 19L, 100L, 1000L, 10000L, 100000L, 1000000L, 10000000L })
+    {
+        benchmark->Arg(digits);
+    }
+}
+
+// Operand pairs: equal sizes, then a long operand against much shorter ones
+static void operand_pairs(benchmark::internal::Benchmark* benchmark)
+{
+    for (long digits : { 19L, 100L, 1000L, 10000L, 100000L, 1000000L, 10000000L })
+    {
+        benchmark->Args({ digits, digits });
+    }
+    benchmark->Args({ 100000L, 100L });
+    benchmark->Args({ 1000000L, 1000L });
+    benchmark->Args({ 10000000L, 10000L });
+    benchmark->Args({ 10000000L, 1000000L });
+}
+
+// Dividend and divisor digits: the classic 2n by n case, then short divisors
+static void division_pairs(benchmark::internal::Benchmark* benchmark)
+{
+    for (long digits : { 38L, 200L, 2000L, 20000L, 200000L, 2000000L, 10000000L })
+    {
+        benchmark->Args({ digits, digits / 2 });
+    }
+    benchmark->Args({ 100000L, 19L });
+    benchmark->Args({ 1000000L, 1000L });
+    benchmark->Args({ 10000000L, 10000L });
+}
+
+static void BM_ConstructFromString(benchmark::State& state)
+{
+    const std::string digits = random_digits(static_cast<std::size_t>(state.range(0)), 1);
+    for (auto _ : state)
+    {
+        BigInteger value(digits);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_ConstructFromString)->Apply(balanced_sizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_ConstructFromInteger(benchmark::State& state)
+{
+    long long value = -1234567890123456789LL;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(value);
+        BigInteger result(value);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_ConstructFromInteger);
+
+static void BM_ToString(benchmark::State& state)
+{
+    const BigInteger value = random_value(static_cast<std::size_t>(state.range(0)), 2);
+    for (auto _ : state)
+    {
+        std::string digits = value.to_string();
+        benchmark::DoNotOptimize(digits);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_ToString)->Apply(balanced_sizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_Serialize(benchmark::State& state)
+{
+    const BigInteger value = random_value(static_cast<std::size_t>(state.range(0)), 17);
+    std::vector<unsigned char> buffer(serialized_size(value));
+    for (auto _ : state)
+    {
+        unsigned char* end = serialize(value, buffer.data(), buffer.data() + buffer.size());
+        benchmark::DoNotOptimize(end);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_Serialize)->Apply(balanced_sizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_Deserialize(benchmark::State& state)
+{
+    const BigInteger value = random_value(static_cast<std::size_t>(state.range(0)), 17);
+    std::vector<unsigned char> buffer(serialized_size(value));
+    serialize(value, buffer.data(), buffer.data() + buffer.size());
+    for (auto _ : state)
+    {
+        const unsigned char* first = buffer.data();
+        BigInteger result = deserialize(first, buffer.data() + buffer.size());
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(BM_Deserialize)->Apply(balanced_sizes)->Unit(benchmark::kMicrosecond);
+
+// Equal lengths that differ only in the lowest digit, the slowest case
+static void BM_Compare(benchmark::State& state)
+{
+    std::string digits = random_digits(static_cast<std::size_t>(state.range(0)), 3);
+    const BigInteger a(digits);
+    digits.back() = digits.back() == '9' ? '8' : static_cast<char>(digits.back() + 1);
+    const BigInteger b(digits);
+    for (auto _ : state)
+    {
+        bool less = a < b;
+        bool equal = a == b;
+        benchmark::DoNotOptimize(less);
+        benchmark::DoNotOptimize(equal);
+    }
+}
+BENCHMARK(BM_Compare)->Apply(balanced_sizes);
+
+static void BM_Add(benchmark::State& state)
+{
+    const BigInteger a = random_value(static_cast<std::size_t>(state.range(0)), 4);
+    const BigInteger b = random_value(static_cast<std::size_t>(state.range(1)), 5);
+    for (auto _ : state)
+    {
+        BigInteger sum = a + b;
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_Add)->Apply(operand_pairs)->Unit(benchmark::kMicrosecond);
+
+static void BM_Subtract(benchmark::State& state)
+{
+    const BigInteger a = random_value(static_cast<std::size_t>(state.range(0)), 6);
+    const BigInteger b = random_value(static_cast<std::size_t>(state.range(1)), 7);
+    for (auto _ : state)
+    {
+        BigInteger difference = a - b;
+        benchmark::DoNotOptimize(difference);
+    }
+}
+BENCHMARK(BM_Subtract)->Apply(operand_pairs)->Unit(benchmark::kMicrosecond);
+
+static void BM_Multiply(benchmark::State& state)
+{
+    const BigInteger a = random_value(static_cast<std::size_t>(state.range(0)), 8);
+    const BigInteger b = random_value(static_cast<std::size_t>(state.range(1)), 9);
+    for (auto _ : state)
+    {
+        BigInteger product = a * b;
+        benchmark::DoNotOptimize(product);
+    }
+}
+BENCHMARK(BM_Multiply)->Apply(operand_pairs)->Unit(benchmark::kMicrosecond);
+
+static void BM_Divide(benchmark::State& state)
+{
+    const BigInteger a = random_value(static_cast<std::size_t>(state.range(0)), 10);
+    const BigInteger b = random_value(static_cast<std::size_t>(state.range(1)), 11);
+    for (auto _ : state)
+    {
+        BigInteger quotient = a / b;
+        benchmark::DoNotOptimize(quotient);
+    }
+}
+BENCHMARK(BM_Divide)->Apply(division_pairs)->Unit(benchmark::kMicrosecond);
+
+static void BM_Modulo(benchmark::State& state)
+{
+    const BigInteger a = random_value(static_cast<std::size_t>(state.range(0)), 12);
+    const BigInteger b = random_value(static_cast<std::size_t>(state.range(1)), 13);
+    for (auto _ : state)
+    {
+        BigInteger remainder = a % b;
+        benchmark::DoNotOptimize(remainder);
+    }
+}
+BENCHMARK(BM_Modulo)->Apply(division_pairs)->Unit(benchmark::kMicrosecond);
+
+// Whole limbs plus a funnel shift
+static void BM_ShiftLeft(benchmark::State& state)
+{
+    const BigInteger a = random_value(static_cast<std::size_t>(state.range(0)), 19);
+    for (auto _ : state)
+    {
+        BigInteger shifted = a << 1000;
+        benchmark::DoNotOptimize(shifted);
+    }
+}
+BENCHMARK(BM_ShiftLeft)->Apply(balanced_sizes)->Unit(benchmark::kMicrosecond);
+
+// The negative operand goes through its two's complement
+static void BM_BitwiseAnd(benchmark::State& state)
+{
+    const BigInteger a = random_value(static_cast<std::size_t>(state.range(0)), 20);
+    const BigInteger b = -random_value(static_cast<std::size_t>(state.range(1)), 21);
+    for (auto _ : state)
+    {
+        BigInteger conjunction = a & b;
+        benchmark::DoNotOptimize(conjunction);
+    }
+}
+BENCHMARK(BM_BitwiseAnd)->Apply(operand_pairs)->Unit(benchmark::kMicrosecond);
+
+// Modulus and exponent of the given digits, the RSA-sized cases. The odd
+// modulus takes the Montgomery path, the even one Barrett.
+static void BM_PowMod(benchmark::State& state)
+{
+    const std::size_t digits = static_cast<std::size_t>(state.range(0));
+    BigInteger modulus = random_value(digits, 14);
+    if ((modulus % BigInteger(2)).is_positive() != (state.range(1) != 0))
+    {
+        modulus += BigInteger(1);
+    }
+    const BigInteger base = random_value(digits - 1, 15);
+    const BigInteger exponent = random_value(digits, 16);
+    for (auto _ : state)
+    {
+        BigInteger result = pow_mod(base, exponent, modulus);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_PowMod)->ArgsProduct({ { 309, 617, 1233, 2466 }, { 1, 0 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,377 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+#include <stdexcept>
+
+// Shifts and bitwise operators on sign and magnitude. The two's complement
+// of a negative value's magnitude m is zero below m's lowest set limb, that
+// limb negated and every limb above it complemented, so neg_n converts an
+// operand in one pass and converts a negative result back the same way.
+
+using bigint_detail::limb_t;
+
+enum class Logic
+{
+    bit_and,
+    bit_or,
+    bit_xor
+};
+
+static limb_t apply(Logic op, limb_t x, limb_t y)
+{
+    switch (op)
+    {
+        case Logic::bit_and:
+            return x & y;
+        case Logic::bit_or:
+            return x | y;
+        default:
+            return x ^ y;
+    }
+}
+
+// r = a << bits. r may be a itself.
+static void shift_left(LimbVector& r, const LimbVector& a, std::size_t bits)
+{
+    const std::size_t n = a.size();
+    const std::size_t limbs = bits / 64;
+    if (n == 1 && a[0] == 0)
+    {
+        r.assign(1, 0);
+        return;
+    }
+    r.resize(n + limbs + 1);
+    limb_t* out = r.data();
+    const limb_t* in = a.data();
+    if (bits % 64)
+    {
+        out[n + limbs] = bigint_detail::lshift(out + limbs, in, n, static_cast<unsigned>(bits % 64));
+    }
+    else
+    {
+        std::copy_backward(in, in + n, out + n + limbs);
+        out[n + limbs] = 0;
+    }
+    std::fill(out, out + limbs, 0);
+}
+
+// r = a >> bits, rounded away from zero for a negative value so the signed
+// result is the floor. r may be a itself.
+static void shift_right(LimbVector& r, const LimbVector& a, bool negative, std::size_t bits)
+{
+    const std::size_t n = a.size();
+    const std::size_t limbs = bits / 64;
+    if (limbs >= n)
+    {
+        r.assign(1, negative ? 1 : 0);
+        return;
+    }
+    bool dropped = std::any_of(a.begin(), a.begin() + limbs, [](limb_t limb) { return limb != 0; });
+    if (&r != &a)
+    {
+        r.resize(n - limbs);
+    }
+    limb_t* out = r.data();
+    const limb_t* in = a.data() + limbs;
+    if (bits % 64)
+    {
+        dropped |= bigint_detail::rshift(out, in, n - limbs, static_cast<unsigned>(bits % 64)) != 0;
+    }
+    else if (out != in)
+    {
+        std::copy(in, in + n - limbs, out);
+    }
+    r.resize(n - limbs);
+    if (negative && dropped && bigint_detail::add_1(r.data(), r.data(), n - limbs, 1))
+    {
+        r.push_back(1);
+    }
+}
+
+// Sets r to the magnitude of a op b and returns the result's sign. r may be
+// either operand.
+static bool bitwise(LimbVector& r, const LimbVector& a, bool a_negative, const LimbVector& b, bool b_negative, Logic op)
+{
+    // Growing r first keeps the operand pointers valid when r is one of them
+    r.reserve(std::max(a.size(), b.size()) + 1);
+    const bool swap = a.size() < b.size();
+    const LimbVector& x = swap ? b : a;
+    const LimbVector& y = swap ? a : b;
+    const bool x_negative = swap ? b_negative : a_negative;
+    const bool y_negative = swap ? a_negative : b_negative;
+    const std::size_t xn = x.size();
+    const std::size_t yn = y.size();
+
+    bigint_detail::ScratchLimbs x_complement;
+    bigint_detail::ScratchLimbs y_complement;
+    const limb_t* xp = x.data();
+    const limb_t* yp = y.data();
+    if (x_negative)
+    {
+        x_complement = bigint_detail::scratch(xn);
+        bigint_detail::neg_n(x_complement.data(), xp, xn);
+        xp = x_complement.data();
+    }
+    if (y_negative)
+    {
+        y_complement = bigint_detail::scratch(yn);
+        bigint_detail::neg_n(y_complement.data(), yp, yn);
+        yp = y_complement.data();
+    }
+
+    r.resize(xn + 1);
+    limb_t* out = r.data();
+    switch (op)
+    {
+        case Logic::bit_and:
+            bigint_detail::and_n(out, xp, yp, yn);
+            break;
+        case Logic::bit_or:
+            bigint_detail::ior_n(out, xp, yp, yn);
+            break;
+        case Logic::bit_xor:
+            bigint_detail::xor_n(out, xp, yp, yn);
+            break;
+    }
+
+    // Above y only its sign fill remains, which either keeps x's limbs,
+    // replaces them or complements them
+    const limb_t fill = y_negative ? ~static_cast<limb_t>(0) : 0;
+    const bool keep = op == Logic::bit_and ? y_negative : !y_negative;
+    if (keep)
+    {
+        if (out != xp)
+        {
+            std::copy(xp + yn, xp + xn, out + yn);
+        }
+    }
+    else if (op == Logic::bit_xor)
+    {
+        bigint_detail::com_n(out + yn, xp + yn, xn - yn);
+    }
+    else
+    {
+        std::fill(out + yn, out + xn, fill);
+    }
+
+    out[xn] = apply(op, x_negative ? ~static_cast<limb_t>(0) : 0, fill);
+    if (out[xn] == 0)
+    {
+        return false;
+    }
+    bigint_detail::neg_n(out, out, xn + 1);
+    return true;
+}
+
+static void check_bits(const LimbVector& a)
+{
+    if (a.empty())
+    {
+        throw std::invalid_argument("Cannot inspect bits of uninitialized BigInteger");
+    }
+}
+
+BigInteger& BigInteger::operator<<=(std::size_t bits)
+{
+    if (number.empty())
+    {
+        throw std::invalid_argument("Cannot shift uninitialized BigInteger");
+    }
+    shift_left(number, number, bits);
+    normalize();
+    return *this;
+}
+
+BigInteger& BigInteger::operator>>=(std::size_t bits)
+{
+    if (number.empty())
+    {
+        throw std::invalid_argument("Cannot shift uninitialized BigInteger");
+    }
+    shift_right(number, number, negative, bits);
+    normalize();
+    return *this;
+}
+
+BigInteger BigInteger::operator<<(std::size_t bits) const
+{
+    if (number.empty())
+    {
+        throw std::invalid_argument("Cannot shift uninitialized BigInteger");
+    }
+    BigInteger result;
+    shift_left(result.number, number, bits);
+    result.negative = negative;
+    result.normalize();
+    return result;
+}
+
+BigInteger BigInteger::operator>>(std::size_t bits) const
+{
+    if (number.empty())
+    {
+        throw std::invalid_argument("Cannot shift uninitialized BigInteger");
+    }
+    BigInteger result;
+    shift_right(result.number, number, negative, bits);
+    result.negative = negative;
+    result.normalize();
+    return result;
+}
+
+BigInteger& BigInteger::operator&=(const BigInteger& other)
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot apply bitwise operator to uninitialized BigInteger");
+    }
+    negative = bitwise(number, number, negative, other.number, other.negative, Logic::bit_and);
+    normalize();
+    return *this;
+}
+
+BigInteger& BigInteger::operator|=(const BigInteger& other)
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot apply bitwise operator to uninitialized BigInteger");
+    }
+    negative = bitwise(number, number, negative, other.number, other.negative, Logic::bit_or);
+    normalize();
+    return *this;
+}
+
+BigInteger& BigInteger::operator^=(const BigInteger& other)
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot apply bitwise operator to uninitialized BigInteger");
+    }
+    negative = bitwise(number, number, negative, other.number, other.negative, Logic::bit_xor);
+    normalize();
+    return *this;
+}
+
+BigInteger BigInteger::operator&(const BigInteger& other) const
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot apply bitwise operator to uninitialized BigInteger");
+    }
+    BigInteger result;
+    result.negative = bitwise(result.number, number, negative, other.number, other.negative, Logic::bit_and);
+    result.normalize();
+    return result;
+}
+
+BigInteger BigInteger::operator|(const BigInteger& other) const
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot apply bitwise operator to uninitialized BigInteger");
+    }
+    BigInteger result;
+    result.negative = bitwise(result.number, number, negative, other.number, other.negative, Logic::bit_or);
+    result.normalize();
+    return result;
+}
+
+BigInteger BigInteger::operator^(const BigInteger& other) const
+{
+    if (number.empty() || other.number.empty())
+    {
+        throw std::invalid_argument("Cannot apply bitwise operator to uninitialized BigInteger");
+    }
+    BigInteger result;
+    result.negative = bitwise(result.number, number, negative, other.number, other.negative, Logic::bit_xor);
+    result.normalize();
+    return result;
+}
+
+// ~x = -x - 1: the magnitude steps up by one for x >= 0 and down by one
+// otherwise, and the sign flips
+BigInteger BigInteger::operator~() const
+{
+    if (number.empty())
+    {
+        throw std::invalid_argument("Cannot apply bitwise operator to uninitialized BigInteger");
+    }
+    BigInteger result(*this);
+    LimbVector& m = result.number;
+    if (negative)
+    {
+        bigint_detail::sub_1(m.data(), m.data(), m.size(), 1);
+    }
+    else if (bigint_detail::add_1(m.data(), m.data(), m.size(), 1))
+    {
+        m.push_back(1);
+    }
+    result.negative = !negative;
+    result.normalize();
+    return result;
+}
+
+std::size_t BigInteger::bit_length() const
+{
+    check_bits(number);
+    const std::size_t n = number.size();
+    const limb_t top = number[n - 1];
+    if (top == 0)
+    {
+        return 0;
+    }
+    std::size_t bits = 64 * n - static_cast<std::size_t>(__builtin_clzll(top));
+    // A negative value needs the bits of |x| - 1, one fewer when |x| is a
+    // power of two
+    if (negative && (top & (top - 1)) == 0
+        && std::all_of(number.begin(), number.end() - 1, [](limb_t limb) { return limb == 0; }))
+    {
+        bits--;
+    }
+    return bits;
+}
+
+std::size_t BigInteger::popcount() const
+{
+    check_bits(number);
+    const std::size_t n = number.size();
+    if (!negative)
+    {
+        return bigint_detail::popcount_n(number.data(), n);
+    }
+    // The clear bits of -m are the set bits of m - 1: the zero limbs below
+    // m's lowest set limb turn to all ones and that limb drops by one
+    std::size_t low = 0;
+    while (number[low] == 0)
+    {
+        low++;
+    }
+    return 64 * low + static_cast<std::size_t>(__builtin_popcountll(number[low] - 1))
+        + bigint_detail::popcount_n(number.data() + low + 1, n - low - 1);
+}
+
+bool BigInteger::test_bit(std::size_t index) const
+{
+    check_bits(number);
+    const std::size_t n = number.size();
+    const std::size_t limb = index / 64;
+    const unsigned bit = static_cast<unsigned>(index % 64);
+    if (!negative)
+    {
+        return limb < n && ((number[limb] >> bit) & 1) != 0;
+    }
+    std::size_t low = 0;
+    while (number[low] == 0)
+    {
+        low++;
+    }
+    if (limb < low)
+    {
+        return false;
+    }
+    if (limb == low)
+    {
+        return ((-number[low] >> bit) & 1) != 0;
+    }
+    return limb >= n || ((number[limb] >> bit) & 1) == 0;
+}
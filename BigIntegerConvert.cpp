@@ -0,0 +1,384 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include "BigIntegerParser.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+// Decimal conversion. Both directions split the value around a power of ten
+// 10^(19 * 2^k) taken from a cached tree of repeated squares, so converting n
+// limbs costs O(M(n) log n) instead of the quadratic limb-by-limb loop.
+
+namespace bigint_detail
+{
+    static const limb_t DECIMAL_BASE = 10000000000000000000ULL;
+    static const std::size_t DECIMAL_BASE_DIGITS = 19;
+
+    const std::vector<limb_t>& power_of_ten(std::size_t k)
+    {
+        // A deque keeps references to earlier entries valid as the tree grows
+        static std::deque<std::vector<limb_t>> powers;
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (powers.empty())
+        {
+            powers.emplace_back(1, DECIMAL_BASE);
+        }
+        while (powers.size() <= k)
+        {
+            const std::vector<limb_t>& previous = powers.back();
+            std::vector<limb_t> square(2 * previous.size());
+            sqr(square.data(), previous.data(), previous.size());
+            square.resize(normalized_size(square.data(), square.size()));
+            powers.push_back(std::move(square));
+        }
+        return powers[k];
+    }
+
+    // Writes the low `count` decimal digits of value ending just before end.
+    static void write_digits(char* end, limb_t value, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            *--end = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+
+    static std::size_t digit_count(limb_t value)
+    {
+        std::size_t count = 1;
+        while (value >= 10)
+        {
+            value /= 10;
+            count++;
+        }
+        return count;
+    }
+
+    // Quadratic conversion for small values, nineteen digits per division.
+    // Values of up to two limbs are converted without touching the heap.
+    static bool write_basecase(const limb_t* a, std::size_t n, std::size_t pad, char*& out, char* last)
+    {
+        limb_t inline_work[2];
+        limb_t inline_chunks[3];
+        ScratchLimbs heap_work(scratch_resource());
+        ScratchLimbs heap_chunks(scratch_resource());
+        limb_t* work = inline_work;
+        limb_t* chunks = inline_chunks;
+        if (n > 2)
+        {
+            heap_work.resize(n);
+            heap_chunks.resize(n + n / 64 + 2);
+            work = heap_work.data();
+            chunks = heap_chunks.data();
+        }
+        std::copy(a, a + n, work);
+
+        std::size_t chunk_count = 0;
+        n = normalized_size(work, n);
+        while (n > 0)
+        {
+            chunks[chunk_count++] = divrem_1(work, work, n, DECIMAL_BASE);
+            n = normalized_size(work, n);
+        }
+
+        std::size_t count = chunk_count == 0 ? 0 : digit_count(chunks[chunk_count - 1]) + DECIMAL_BASE_DIGITS * (chunk_count - 1);
+        std::size_t width = pad ? pad : std::max<std::size_t>(count, 1);
+        if (static_cast<std::size_t>(last - out) < width)
+        {
+            return false;
+        }
+        std::fill(out, out + (width - count), '0');
+        char* end = out + width;
+        for (std::size_t i = 0; i < chunk_count; i++)
+        {
+            bool top = i + 1 == chunk_count;
+            write_digits(end, chunks[i], top ? digit_count(chunks[i]) : DECIMAL_BASE_DIGITS);
+            end -= DECIMAL_BASE_DIGITS;
+        }
+        out += width;
+        return true;
+    }
+
+    // Writes a in decimal at out, advancing it. With a nonzero pad exactly that
+    // many digits are written, zero filled on the left. Returns false if the
+    // digits do not fit before last.
+    static bool write_recursive(const limb_t* a, std::size_t n, std::size_t pad, char*& out, char* last)
+    {
+        n = normalized_size(a, n);
+        if (n < std::max<std::size_t>(BigInteger::thresholds().conversion, 2))
+        {
+            note_algorithm(BigIntegerAlgorithm::schoolbook);
+            return write_basecase(a, n, pad, out, last);
+        }
+        note_algorithm(BigIntegerAlgorithm::divide_and_conquer);
+
+        // Largest power whose square still reaches about the size of a
+        std::size_t k = 0;
+        while (2 * power_of_ten(k + 1).size() <= n)
+        {
+            k++;
+        }
+        const std::vector<limb_t>& power = power_of_ten(k);
+        const std::size_t low_digits = DECIMAL_BASE_DIGITS << k;
+        const std::size_t pn = power.size();
+
+        ScratchLimbs quotient = scratch(n - pn + 1);
+        ScratchLimbs remainder = scratch(pn);
+        divrem(quotient.data(), remainder.data(), a, n, power.data(), pn);
+        std::size_t high_pad = pad ? pad - low_digits : 0;
+        return write_recursive(quotient.data(), quotient.size(), high_pad, out, last)
+            && write_recursive(remainder.data(), remainder.size(), low_digits, out, last);
+    }
+
+    bool write_decimal(const limb_t* a, std::size_t n, char*& out, char* last)
+    {
+        return write_recursive(a, n, 0, out, last);
+    }
+
+    std::vector<limb_t> parse_decimal(const char* digits, std::size_t length)
+    {
+        const std::size_t basecase_digits = DECIMAL_BASE_DIGITS * std::max<std::size_t>(BigInteger::thresholds().conversion, 2);
+        if (length <= basecase_digits)
+        {
+            note_algorithm(BigIntegerAlgorithm::schoolbook);
+            std::vector<limb_t> result;
+            result.reserve(length / DECIMAL_BASE_DIGITS + 1);
+            std::size_t chunk = length % DECIMAL_BASE_DIGITS;
+            if (chunk == 0)
+            {
+                chunk = DECIMAL_BASE_DIGITS;
+            }
+            for (std::size_t pos = 0; pos < length; pos += chunk, chunk = DECIMAL_BASE_DIGITS)
+            {
+                limb_t value = 0;
+                limb_t scale = 1;
+                for (std::size_t i = pos; i < pos + chunk; i++)
+                {
+                    value = value * 10 + static_cast<limb_t>(digits[i] - '0');
+                    scale *= 10;
+                }
+                limb_t carry = mul_1(result.data(), result.data(), result.size(), scale);
+                carry += add_1(result.data(), result.data(), result.size(), value);
+                if (carry)
+                {
+                    result.push_back(carry);
+                }
+            }
+            result.resize(normalized_size(result.data(), result.size()));
+            return result;
+        }
+
+        note_algorithm(BigIntegerAlgorithm::divide_and_conquer);
+
+        // Split off the largest 19 * 2^k digit tail shorter than the input
+        std::size_t k = 0;
+        while ((DECIMAL_BASE_DIGITS << (k + 1)) < length)
+        {
+            k++;
+        }
+        const std::size_t low_digits = DECIMAL_BASE_DIGITS << k;
+        std::vector<limb_t> high = parse_decimal(digits, length - low_digits);
+        std::vector<limb_t> low = parse_decimal(digits + length - low_digits, low_digits);
+        const std::vector<limb_t>& power = power_of_ten(k);
+
+        std::vector<limb_t> result(high.size() + power.size() + 1);
+        mul(result.data(), high.data(), high.size(), power.data(), power.size());
+        result.back() = 0;
+        add(result.data(), result.data(), result.size(), low.data(), low.size());
+        result.resize(normalized_size(result.data(), result.size()));
+        return result;
+    }
+}
+
+BigIntegerParser::BigIntegerParser()
+{
+    reset();
+}
+
+void BigIntegerParser::reset()
+{
+    segments.clear();
+    pending = 0;
+    digits = 0;
+    negative = false;
+    started = false;
+    stopped = false;
+}
+
+bool BigIntegerParser::done() const
+{
+    return stopped;
+}
+
+std::size_t BigIntegerParser::feed(const char* first, const char* last)
+{
+    const char* in = first;
+    if (stopped)
+    {
+        return 0;
+    }
+    if (!started && in != last)
+    {
+        started = true;
+        if (*in == '-')
+        {
+            negative = true;
+            in++;
+        }
+    }
+    while (in != last)
+    {
+        if (*in < '0' || *in > '9')
+        {
+            stopped = true;
+            break;
+        }
+        block[pending++] = *in++;
+        digits++;
+        if (pending == BLOCK_DIGITS)
+        {
+            push_block();
+        }
+    }
+    return static_cast<std::size_t>(in - first);
+}
+
+// Converts the full block and merges equal levels: the segment below is the
+// more significant half
+void BigIntegerParser::push_block()
+{
+    segments.push_back(Segment{ bigint_detail::parse_decimal(block, BLOCK_DIGITS), 0 });
+    pending = 0;
+    while (segments.size() >= 2 && segments[segments.size() - 2].level == segments.back().level)
+    {
+        Segment low = std::move(segments.back());
+        segments.pop_back();
+        Segment& high = segments.back();
+        const std::vector<bigint_detail::limb_t>& power = bigint_detail::power_of_ten(BLOCK_LOG + low.level);
+        std::vector<bigint_detail::limb_t> merged(high.limbs.size() + power.size() + 1);
+        bigint_detail::mul(merged.data(), high.limbs.data(), high.limbs.size(), power.data(), power.size());
+        bigint_detail::add(merged.data(), merged.data(), merged.size(), low.limbs.data(), low.limbs.size());
+        merged.resize(bigint_detail::normalized_size(merged.data(), merged.size()));
+        high.limbs = std::move(merged);
+        high.level++;
+    }
+}
+
+BigInteger BigIntegerParser::finish()
+{
+    if (digits == 0)
+    {
+        reset();
+        throw std::invalid_argument("Cannot parse BigInteger from input without digits");
+    }
+    bigint_detail::OperationScope scope(BigIntegerOperation::from_decimal, digits / 19 + 1);
+
+    // Fold the segments into the partial block from the least significant
+    // up, keeping 10^(digits so far) alongside
+    std::vector<bigint_detail::limb_t> value = bigint_detail::parse_decimal(block, pending);
+    std::vector<bigint_detail::limb_t> scale(1, 1);
+    for (std::size_t i = 0; i < pending; i += 19)
+    {
+        const std::size_t count = std::min<std::size_t>(19, pending - i);
+        bigint_detail::limb_t factor = 1;
+        for (std::size_t k = 0; k < count; k++)
+        {
+            factor *= 10;
+        }
+        scale.push_back(bigint_detail::mul_1(scale.data(), scale.data(), scale.size(), factor));
+        scale.resize(bigint_detail::normalized_size(scale.data(), scale.size()));
+    }
+    for (std::size_t i = segments.size(); i-- > 0;)
+    {
+        const Segment& segment = segments[i];
+        std::vector<bigint_detail::limb_t> sum(std::max(segment.limbs.size() + scale.size(), value.size()) + 1);
+        bigint_detail::mul(sum.data(), segment.limbs.data(), segment.limbs.size(), scale.data(), scale.size());
+        bigint_detail::add(sum.data(), sum.data(), sum.size(), value.data(), value.size());
+        sum.resize(bigint_detail::normalized_size(sum.data(), sum.size()));
+        value = std::move(sum);
+        if (i > 0)
+        {
+            const std::vector<bigint_detail::limb_t>& power = bigint_detail::power_of_ten(BLOCK_LOG + segment.level);
+            std::vector<bigint_detail::limb_t> next(scale.size() + power.size());
+            bigint_detail::mul(next.data(), scale.data(), scale.size(), power.data(), power.size());
+            next.resize(bigint_detail::normalized_size(next.data(), next.size()));
+            scale = std::move(next);
+        }
+    }
+
+    BigInteger result(0);
+    if (!value.empty())
+    {
+        result.number.assign(value.data(), value.data() + value.size());
+        result.negative = negative;
+    }
+    reset();
+    return result;
+}
+
+BigInteger BigIntegerParser::parse(const std::function<std::size_t(char* buffer, std::size_t size)>& source)
+{
+    BigIntegerParser parser;
+    char buffer[4096];
+    while (!parser.done())
+    {
+        const std::size_t count = source(buffer, sizeof(buffer));
+        if (count == 0)
+        {
+            break;
+        }
+        parser.feed(buffer, buffer + count);
+    }
+    return parser.finish();
+}
+
+std::istream& operator>>(std::istream& is, BigInteger& value)
+{
+    std::istream::sentry sentry(is);
+    if (!sentry)
+    {
+        return is;
+    }
+    // Characters are only taken off the stream once they are known to
+    // belong to the number, and handed to the parser a buffer at a time
+    BigIntegerParser parser;
+    std::streambuf* buffer = is.rdbuf();
+    char chunk[4096];
+    std::size_t count = 0;
+    bool any = false;
+    bool first = true;
+    while (true)
+    {
+        const std::streambuf::int_type next = buffer->sgetc();
+        if (std::streambuf::traits_type::eq_int_type(next, std::streambuf::traits_type::eof()))
+        {
+            is.setstate(std::ios_base::eofbit);
+            break;
+        }
+        const char c = std::streambuf::traits_type::to_char_type(next);
+        if (!(c >= '0' && c <= '9') && !(first && c == '-'))
+        {
+            break;
+        }
+        any = any || c != '-';
+        first = false;
+        chunk[count++] = c;
+        buffer->sbumpc();
+        if (count == sizeof(chunk))
+        {
+            parser.feed(chunk, chunk + count);
+            count = 0;
+        }
+    }
+    parser.feed(chunk, chunk + count);
+    if (!any)
+    {
+        is.setstate(std::ios_base::failbit);
+        return is;
+    }
+    value = parser.finish();
+    return is;
+}
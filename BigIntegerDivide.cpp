@@ -0,0 +1,220 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+
+namespace bigint_detail
+{
+    void divrem_normalized(limb_t* q, limb_t* u, std::size_t un, const limb_t* v, std::size_t vn)
+    {
+        const limb_t v1 = v[vn - 1];
+        const limb_t v2 = v[vn - 2];
+        for (std::size_t j = un - vn; j-- > 0;)
+        {
+            const limb_t u2 = u[j + vn];
+            const limb_t u1 = u[j + vn - 1];
+            const limb_t u0 = u[j + vn - 2];
+
+            // Estimate the quotient limb from the top two limbs of the divisor;
+            // the estimate is at most two too large.
+            limb_t qhat;
+            limb_t rhat;
+            bool rhat_overflow = false;
+            if (u2 >= v1)
+            {
+                qhat = ~static_cast<limb_t>(0);
+                rhat = u1 + v1;
+                rhat_overflow = rhat < v1;
+            }
+            else
+            {
+                qhat = div_2by1(u2, u1, v1, rhat);
+            }
+            while (!rhat_overflow && static_cast<dlimb_t>(qhat) * v2 > ((static_cast<dlimb_t>(rhat) << 64) | u0))
+            {
+                qhat--;
+                rhat += v1;
+                rhat_overflow = rhat < v1;
+            }
+
+            limb_t borrow = submul_1(u + j, v, vn, qhat);
+            limb_t top = u[j + vn];
+            u[j + vn] = top - borrow;
+            if (top < borrow)
+            {
+                // Estimate was one too large: add the divisor back
+                qhat--;
+                u[j + vn] += add_n(u + j, u + j, v, vn);
+            }
+            q[j] = qhat;
+        }
+    }
+
+    static unsigned leading_zeros(limb_t x)
+    {
+        return static_cast<unsigned>(__builtin_clzll(x));
+    }
+
+    static void divrem_knuth(limb_t* q, limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        const unsigned shift = leading_zeros(b[bn - 1]);
+        ScratchLimbs v = scratch(b, b + bn);
+        ScratchLimbs u = scratch(an + 1);
+        if (shift)
+        {
+            lshift(v.data(), b, bn, shift);
+            u[an] = lshift(u.data(), a, an, shift);
+        }
+        else
+        {
+            std::copy(a, a + an, u.begin());
+        }
+        divrem_normalized(q, u.data(), an + 1, v.data(), bn);
+        if (shift)
+        {
+            rshift(r, u.data(), bn, shift);
+        }
+        else
+        {
+            std::copy(u.begin(), u.begin() + bn, r);
+        }
+    }
+
+    static void div_3n2n(limb_t* q, limb_t* r, const limb_t* a, const limb_t* b, std::size_t h);
+
+    // Burnikel-Ziegler step: divides a (2n limbs) by the normalized b (n limbs)
+    // where a < b * B^n, giving an n-limb quotient and remainder.
+    static void div_2n1n(limb_t* q, limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        if (n % 2 != 0 || n <= 2 || n < BigInteger::thresholds().burnikel_ziegler)
+        {
+            ScratchLimbs u = scratch(a, a + 2 * n);
+            divrem_normalized(q, u.data(), 2 * n, b, n);
+            std::copy(u.begin(), u.begin() + n, r);
+            return;
+        }
+
+        // Split a into four h-limb pieces and divide the top three, then the
+        // remainder joined with the last piece.
+        const std::size_t h = n / 2;
+        ScratchLimbs upper = scratch(3 * h);
+        div_3n2n(q + h, upper.data() + h, a + h, b, h);
+        std::copy(a, a + h, upper.begin());
+        div_3n2n(q, r, upper.data(), b, h);
+    }
+
+    // Divides a (3h limbs) by the normalized b (2h limbs) where a < b * B^h,
+    // giving an h-limb quotient and a 2h-limb remainder.
+    static void div_3n2n(limb_t* q, limb_t* r, const limb_t* a, const limb_t* b, std::size_t h)
+    {
+        const limb_t* b_low = b;
+        const limb_t* b_high = b + h;
+
+        // rhat holds R1 * B^h + a_low - D as a (2h + 1)-limb two's complement value
+        ScratchLimbs rhat = scratch(2 * h + 1);
+        std::copy(a, a + h, rhat.begin());
+        if (cmp_n(a + 2 * h, b_high, h) < 0)
+        {
+            div_2n1n(q, rhat.data() + h, a + h, b_high, h);
+        }
+        else
+        {
+            // The top piece equals b_high, so the quotient estimate is B^h - 1
+            // and R1 = a_mid + b_high.
+            std::fill(q, q + h, ~static_cast<limb_t>(0));
+            rhat[2 * h] = add_n(rhat.data() + h, a + h, b_high, h);
+        }
+
+        ScratchLimbs d = scratch(2 * h);
+        mul(d.data(), q, h, b_low, h);
+        bool negative = sub(rhat.data(), rhat.data(), 2 * h + 1, d.data(), 2 * h) != 0;
+        while (negative)
+        {
+            sub_1(q, q, h, 1);
+            negative = add(rhat.data(), rhat.data(), 2 * h + 1, b, 2 * h) == 0;
+        }
+        std::copy(rhat.begin(), rhat.begin() + 2 * h, r);
+    }
+
+    static void divrem_burnikel_ziegler(limb_t* q, limb_t* r, const limb_t* a, std::size_t an,
+                                        const limb_t* b, std::size_t bn)
+    {
+        // Pick a block size n >= bn that halves evenly down to the base case size
+        const std::size_t base = std::max<std::size_t>(BigInteger::thresholds().burnikel_ziegler, 2);
+        std::size_t blocks = 1;
+        while (blocks * base < bn)
+        {
+            blocks <<= 1;
+        }
+        const std::size_t n = (bn + blocks - 1) / blocks * blocks;
+        const std::size_t pad = n - bn;
+        const unsigned shift = leading_zeros(b[bn - 1]);
+
+        // Scale both operands so the divisor fills n limbs with its top bit set
+        ScratchLimbs divisor = scratch(n);
+        ScratchLimbs dividend = scratch(an + pad + 1);
+        if (shift)
+        {
+            lshift(divisor.data() + pad, b, bn, shift);
+            dividend[an + pad] = lshift(dividend.data() + pad, a, an, shift);
+        }
+        else
+        {
+            std::copy(b, b + bn, divisor.begin() + pad);
+            std::copy(a, a + an, dividend.begin() + pad);
+        }
+
+        // Enough n-limb blocks that the top one is below the divisor
+        std::size_t used = normalized_size(dividend.data(), dividend.size());
+        std::size_t t = std::max<std::size_t>(2, (used + n - 1) / n);
+        dividend.resize(t * n, 0);
+        if (cmp_n(dividend.data() + (t - 1) * n, divisor.data(), n) >= 0)
+        {
+            t++;
+            dividend.resize(t * n, 0);
+        }
+
+        ScratchLimbs quotient = scratch(std::max((t - 1) * n, an - bn + 1));
+        ScratchLimbs window = scratch(dividend.data() + (t - 2) * n, dividend.data() + t * n);
+        ScratchLimbs remainder = scratch(n);
+        for (std::size_t i = t - 1; i-- > 0;)
+        {
+            div_2n1n(quotient.data() + i * n, remainder.data(), window.data(), divisor.data(), n);
+            if (i > 0)
+            {
+                std::copy(dividend.begin() + (i - 1) * n, dividend.begin() + i * n, window.begin());
+                std::copy(remainder.begin(), remainder.end(), window.begin() + n);
+            }
+        }
+
+        std::copy(quotient.begin(), quotient.begin() + (an - bn + 1), q);
+        if (shift)
+        {
+            rshift(r, remainder.data() + pad, bn, shift);
+        }
+        else
+        {
+            std::copy(remainder.begin() + pad, remainder.end(), r);
+        }
+    }
+
+    void divrem(limb_t* q, limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        if (bn == 1)
+        {
+            note_algorithm(BigIntegerAlgorithm::linear);
+            r[0] = divrem_1(q, a, an, b[0]);
+            return;
+        }
+        const std::size_t threshold = BigInteger::thresholds().burnikel_ziegler;
+        if (bn < threshold || an - bn < threshold)
+        {
+            note_algorithm(BigIntegerAlgorithm::knuth);
+            divrem_knuth(q, r, a, an, b, bn);
+        }
+        else
+        {
+            note_algorithm(BigIntegerAlgorithm::burnikel_ziegler);
+            divrem_burnikel_ziegler(q, r, a, an, b, bn);
+        }
+    }
+}
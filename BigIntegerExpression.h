@@ -0,0 +1,282 @@
+#pragma once
+
+#include "BigInteger.h"
+#include <type_traits>
+
+// Opt-in expression templates. Wrapping an operand in lazy() makes + - and *
+// build an expression tree instead of a BigInteger per step; the tree is
+// evaluated in one pass when it is assigned to a BigInteger, reusing the
+// destination's limbs:
+//
+//     result = lazy(a) * b + c - d;
+//
+// A product added to or subtracted from another term goes through the fused
+// addmul/submul kernel, so no temporary ever holds it. Expressions refer to
+// their operands, so they must be assigned within the same statement.
+
+template<typename Derived>
+class BigIntegerExpression
+{
+    public:
+        const Derived& derived() const
+        {
+            return static_cast<const Derived&>(*this);
+        }
+};
+
+class BigIntegerTerm : public BigIntegerExpression<BigIntegerTerm>
+{
+    public:
+        explicit BigIntegerTerm(const BigInteger& operand)
+            : operand(operand)
+        {
+        }
+
+        void evaluate(BigInteger& out) const
+        {
+            out = operand;
+        }
+
+        bool refers_to(const BigInteger* target) const
+        {
+            return &operand == target;
+        }
+
+        const BigInteger& operand;
+};
+
+template<typename L, typename R>
+class BigIntegerProduct : public BigIntegerExpression<BigIntegerProduct<L, R>>
+{
+    public:
+        BigIntegerProduct(const L& left, const R& right)
+            : left(left), right(right)
+        {
+        }
+
+        void evaluate(BigInteger& out) const;
+
+        bool refers_to(const BigInteger* target) const
+        {
+            return left.refers_to(target) || right.refers_to(target);
+        }
+
+        L left;
+        R right;
+};
+
+template<typename L, typename R, bool Subtract>
+class BigIntegerSum : public BigIntegerExpression<BigIntegerSum<L, R, Subtract>>
+{
+    public:
+        BigIntegerSum(const L& left, const R& right)
+            : left(left), right(right)
+        {
+        }
+
+        void evaluate(BigInteger& out) const;
+
+        bool refers_to(const BigInteger* target) const
+        {
+            return left.refers_to(target) || right.refers_to(target);
+        }
+
+        L left;
+        R right;
+};
+
+inline BigIntegerTerm lazy(const BigInteger& value)
+{
+    return BigIntegerTerm(value);
+}
+
+namespace bigint_detail
+{
+    template<typename E>
+    struct is_product : std::false_type
+    {
+    };
+
+    template<typename L, typename R>
+    struct is_product<BigIntegerProduct<L, R>> : std::true_type
+    {
+    };
+
+    // A subexpression evaluated into its own BigInteger; plain terms are
+    // borrowed instead of copied.
+    template<typename E>
+    class Evaluated
+    {
+        public:
+            explicit Evaluated(const E& expression)
+            {
+                expression.evaluate(storage);
+            }
+
+            const BigInteger& get() const
+            {
+                return storage;
+            }
+
+        private:
+            BigInteger storage;
+    };
+
+    template<>
+    class Evaluated<BigIntegerTerm>
+    {
+        public:
+            explicit Evaluated(const BigIntegerTerm& term)
+                : operand(term.operand)
+            {
+            }
+
+            const BigInteger& get() const
+            {
+                return operand;
+            }
+
+        private:
+            const BigInteger& operand;
+    };
+
+    // out += product, or out -= product, through the fused kernel
+    template<typename L, typename R>
+    void accumulate_product(BigInteger& out, const BigIntegerProduct<L, R>& product, bool subtract)
+    {
+        Evaluated<L> left(product.left);
+        Evaluated<R> right(product.right);
+        if (subtract)
+        {
+            out.submul(left.get(), right.get());
+        }
+        else
+        {
+            out.addmul(left.get(), right.get());
+        }
+    }
+}
+
+template<typename L, typename R>
+void BigIntegerProduct<L, R>::evaluate(BigInteger& out) const
+{
+    left.evaluate(out);
+    bigint_detail::Evaluated<R> factor(right);
+    out *= factor.get();
+}
+
+template<typename L, typename R, bool Subtract>
+void BigIntegerSum<L, R, Subtract>::evaluate(BigInteger& out) const
+{
+    if constexpr (bigint_detail::is_product<R>::value)
+    {
+        left.evaluate(out);
+        bigint_detail::accumulate_product(out, right, Subtract);
+    }
+    else if constexpr (bigint_detail::is_product<L>::value)
+    {
+        // x * y - r is evaluated as -r + x * y
+        right.evaluate(out);
+        if (Subtract)
+        {
+            out = -std::move(out);
+        }
+        bigint_detail::accumulate_product(out, left, false);
+    }
+    else
+    {
+        left.evaluate(out);
+        bigint_detail::Evaluated<R> term(right);
+        if (Subtract)
+        {
+            out -= term.get();
+        }
+        else
+        {
+            out += term.get();
+        }
+    }
+}
+
+template<typename L, typename R>
+BigIntegerSum<L, R, false> operator+(const BigIntegerExpression<L>& left, const BigIntegerExpression<R>& right)
+{
+    return BigIntegerSum<L, R, false>(left.derived(), right.derived());
+}
+
+template<typename L>
+BigIntegerSum<L, BigIntegerTerm, false> operator+(const BigIntegerExpression<L>& left, const BigInteger& right)
+{
+    return BigIntegerSum<L, BigIntegerTerm, false>(left.derived(), BigIntegerTerm(right));
+}
+
+template<typename R>
+BigIntegerSum<BigIntegerTerm, R, false> operator+(const BigInteger& left, const BigIntegerExpression<R>& right)
+{
+    return BigIntegerSum<BigIntegerTerm, R, false>(BigIntegerTerm(left), right.derived());
+}
+
+template<typename L, typename R>
+BigIntegerSum<L, R, true> operator-(const BigIntegerExpression<L>& left, const BigIntegerExpression<R>& right)
+{
+    return BigIntegerSum<L, R, true>(left.derived(), right.derived());
+}
+
+template<typename L>
+BigIntegerSum<L, BigIntegerTerm, true> operator-(const BigIntegerExpression<L>& left, const BigInteger& right)
+{
+    return BigIntegerSum<L, BigIntegerTerm, true>(left.derived(), BigIntegerTerm(right));
+}
+
+template<typename R>
+BigIntegerSum<BigIntegerTerm, R, true> operator-(const BigInteger& left, const BigIntegerExpression<R>& right)
+{
+    return BigIntegerSum<BigIntegerTerm, R, true>(BigIntegerTerm(left), right.derived());
+}
+
+template<typename L, typename R>
+BigIntegerProduct<L, R> operator*(const BigIntegerExpression<L>& left, const BigIntegerExpression<R>& right)
+{
+    return BigIntegerProduct<L, R>(left.derived(), right.derived());
+}
+
+template<typename L>
+BigIntegerProduct<L, BigIntegerTerm> operator*(const BigIntegerExpression<L>& left, const BigInteger& right)
+{
+    return BigIntegerProduct<L, BigIntegerTerm>(left.derived(), BigIntegerTerm(right));
+}
+
+template<typename R>
+BigIntegerProduct<BigIntegerTerm, R> operator*(const BigInteger& left, const BigIntegerExpression<R>& right)
+{
+    return BigIntegerProduct<BigIntegerTerm, R>(BigIntegerTerm(left), right.derived());
+}
+
+// Accumulating a product into an existing value is a single fused pass
+template<typename E>
+BigInteger& operator+=(BigInteger& out, const BigIntegerExpression<E>& expression)
+{
+    if constexpr (bigint_detail::is_product<E>::value)
+    {
+        bigint_detail::accumulate_product(out, expression.derived(), false);
+        return out;
+    }
+    else
+    {
+        return out += BigInteger(expression);
+    }
+}
+
+template<typename E>
+BigInteger& operator-=(BigInteger& out, const BigIntegerExpression<E>& expression)
+{
+    if constexpr (bigint_detail::is_product<E>::value)
+    {
+        bigint_detail::accumulate_product(out, expression.derived(), true);
+        return out;
+    }
+    else
+    {
+        return out -= BigInteger(expression);
+    }
+}
@@ -0,0 +1,485 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include "BigIntegerNumeric.h"
+#include <algorithm>
+#include <stdexcept>
+
+// Greatest common divisors. Every algorithm reduces a pair a >= b >= 0 by
+// integer 2x2 transforms of determinant +-1, which keep the gcd:
+//
+// - up to two limbs, binary GCD on native integers;
+// - Lehmer's algorithm: Euclid on the leading 128 bits of a and b yields
+//   single-limb cofactors standing for up to a limb's worth of quotients,
+//   applied to the full values in one linear pass;
+// - from thresholds().half_gcd limbs, half-GCD: the transform that halves
+//   the top half of the operands removes a quarter of their length when
+//   applied to the whole, so two recursive calls and a few products halve
+//   them. Cofactors are tracked throughout the recursion, which makes its
+//   Lehmer base case dearer than plain Lehmer; hence the high threshold.
+//
+// Transforms worked out on truncated operands may overshoot by the last
+// quotient or two. The pair is then made nonnegative and reordered, which
+// still keeps the gcd, and a transform that fails to shrink a is dropped.
+
+namespace bigint_detail
+{
+    class GcdReduction
+    {
+        public:
+            // a >= b >= 0. With track set, matrix follows the transform from
+            // the starting pair to the current one.
+            GcdReduction(BigInteger a, BigInteger b, bool track);
+
+            // |value|, throwing for an uninitialized one
+            static BigInteger magnitude(const BigInteger& value);
+
+            // Reduces until b is zero, leaving the gcd in a
+            void run();
+
+            // Reduces until b has at most half of a's starting limbs,
+            // rounded up
+            void half();
+
+            BigInteger a;
+            BigInteger b;
+            // (a, b) = matrix * (starting a, starting b)
+            BigInteger matrix[2][2];
+
+        private:
+            bool track;
+
+            void step();
+            bool lehmer_step();
+            void division_step();
+            void binary_step();
+            void reduce_top(std::size_t k);
+            bool apply(BigInteger transform[2][2]);
+            void update(BigInteger transform[2][2]);
+            static void store(BigInteger& value, const limb_t* r, std::size_t n);
+    };
+
+    namespace
+    {
+        // The recursion inside half-GCD bottoms out this many times below
+        // the size at which gcd() starts using it: halving a pair once costs
+        // less than running it down to the gcd.
+        const std::size_t HALF_GCD_BASE = 8;
+
+        // 128 bits of a starting at bit shift, zero beyond the top
+        dlimb_t window(const limb_t* a, std::size_t n, std::size_t shift)
+        {
+            const std::size_t i = shift / 64;
+            const unsigned bits = static_cast<unsigned>(shift % 64);
+            limb_t limbs[3];
+            for (std::size_t k = 0; k < 3; k++)
+            {
+                limbs[k] = i + k < n ? a[i + k] : 0;
+            }
+            if (bits == 0)
+            {
+                return (static_cast<dlimb_t>(limbs[1]) << 64) | limbs[0];
+            }
+            limb_t low = (limbs[0] >> bits) | (limbs[1] << (64 - bits));
+            limb_t high = (limbs[1] >> bits) | (limbs[2] << (64 - bits));
+            return (static_cast<dlimb_t>(high) << 64) | low;
+        }
+
+        // r = |x * a - y * b| over an + 1 limbs for an >= bn, returning
+        // whether the difference was negative.
+        bool combine(limb_t* r, const limb_t* a, std::size_t an, limb_t x, const limb_t* b, std::size_t bn, limb_t y)
+        {
+            r[an] = mul_1(r, a, an, x);
+            limb_t borrow = submul_1(r, b, bn, y);
+            borrow = sub_1(r + bn, r + bn, an + 1 - bn, borrow);
+            if (!borrow)
+            {
+                return false;
+            }
+            for (std::size_t i = 0; i <= an; i++)
+            {
+                r[i] = ~r[i];
+            }
+            add_1(r, r, an + 1, 1);
+            return true;
+        }
+
+        unsigned trailing_zeros(dlimb_t x)
+        {
+            limb_t low = static_cast<limb_t>(x);
+            return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll(static_cast<limb_t>(x >> 64));
+        }
+
+        BigInteger signed_limb(limb_t value, bool negative)
+        {
+            BigInteger result(value);
+            return negative ? -result : result;
+        }
+    }
+
+    GcdReduction::GcdReduction(BigInteger a, BigInteger b, bool track)
+        : a(std::move(a)), b(std::move(b)), track(track)
+    {
+        if (track)
+        {
+            matrix[0][0] = BigInteger(1);
+            matrix[0][1] = BigInteger(0);
+            matrix[1][0] = BigInteger(0);
+            matrix[1][1] = BigInteger(1);
+        }
+    }
+
+    BigInteger GcdReduction::magnitude(const BigInteger& value)
+    {
+        if (value.number.empty())
+        {
+            throw std::invalid_argument("Cannot take the gcd of uninitialized BigInteger");
+        }
+        BigInteger result = value;
+        result.negative = false;
+        return result;
+    }
+
+    void GcdReduction::store(BigInteger& value, const limb_t* r, std::size_t n)
+    {
+        const std::size_t size = normalized_size(r, n);
+        value.number.assign(r, r + std::max<std::size_t>(size, 1));
+        value.negative = false;
+    }
+
+    void GcdReduction::run()
+    {
+        while (b.is_positive())
+        {
+            const std::size_t n = a.number.size();
+            if (n >= BigInteger::thresholds().half_gcd && b.number.size() + 1 >= n)
+            {
+                half();
+            }
+            else
+            {
+                step();
+            }
+        }
+    }
+
+    void GcdReduction::half()
+    {
+        const std::size_t n = a.number.size();
+        const std::size_t target = n - n / 2;
+        if (n >= std::max<std::size_t>(BigInteger::thresholds().half_gcd / HALF_GCD_BASE, 4))
+        {
+            reduce_top(n / 2);
+            const std::size_t m = a.number.size();
+            if (b.number.size() > target && 2 * target > m)
+            {
+                reduce_top(2 * target - m);
+            }
+        }
+        while (b.is_positive() && b.number.size() > target)
+        {
+            step();
+        }
+    }
+
+    // Halves the pair formed by the limbs of a and b from k up, then applies
+    // its transform to the whole of a and b.
+    void GcdReduction::reduce_top(std::size_t k)
+    {
+        if (b.number.size() <= k)
+        {
+            return;
+        }
+        BigInteger top_a(0);
+        BigInteger top_b(0);
+        store(top_a, a.number.data() + k, a.number.size() - k);
+        store(top_b, b.number.data() + k, b.number.size() - k);
+        GcdReduction top(std::move(top_a), std::move(top_b), true);
+        top.half();
+        apply(top.matrix);
+    }
+
+    void GcdReduction::step()
+    {
+        const std::size_t an = a.number.size();
+        const std::size_t bn = b.number.size();
+        if (an <= 2 && !track)
+        {
+            binary_step();
+        }
+        else if (an < 2 || bn + 1 < an || !lehmer_step())
+        {
+            division_step();
+        }
+    }
+
+    // Finishes a pair of at most two limbs by binary GCD
+    void GcdReduction::binary_step()
+    {
+        dlimb_t x = a.number[0];
+        dlimb_t y = b.number[0];
+        if (a.number.size() > 1)
+        {
+            x |= static_cast<dlimb_t>(a.number[1]) << 64;
+        }
+        if (b.number.size() > 1)
+        {
+            y |= static_cast<dlimb_t>(b.number[1]) << 64;
+        }
+        const unsigned shift = trailing_zeros(x | y);
+        x >>= trailing_zeros(x);
+        do
+        {
+            y >>= trailing_zeros(y);
+            if (x > y)
+            {
+                std::swap(x, y);
+            }
+            y -= x;
+        } while (y != 0);
+        x <<= shift;
+        const limb_t limbs[2] = { static_cast<limb_t>(x), static_cast<limb_t>(x >> 64) };
+        store(a, limbs, 2);
+        b = BigInteger(0);
+    }
+
+    void GcdReduction::division_step()
+    {
+        std::pair<BigInteger, BigInteger> qr = divmod(a, b);
+        if (track)
+        {
+            matrix[0][0].submul(qr.first, matrix[1][0]);
+            matrix[0][1].submul(qr.first, matrix[1][1]);
+            std::swap(matrix[0][0], matrix[1][0]);
+            std::swap(matrix[0][1], matrix[1][1]);
+        }
+        a = std::move(b);
+        b = std::move(qr.second);
+    }
+
+    // One Lehmer step; false if the leading bits allowed no quotient or the
+    // cofactors failed to shrink the pair.
+    bool GcdReduction::lehmer_step()
+    {
+        const limb_t* ap = a.number.data();
+        const limb_t* bp = b.number.data();
+        const std::size_t an = a.number.size();
+        const std::size_t bn = b.number.size();
+        const std::size_t bits = 64 * an - __builtin_clzll(ap[an - 1]);
+        const std::size_t shift = bits > 128 ? bits - 128 : 0;
+        dlimb_t high_a = window(ap, an, shift);
+        dlimb_t high_b = window(bp, bn, shift);
+
+        // Euclid on the leading bits while the quotients provably match
+        // those of the full values: the remainders have to stay above the
+        // cofactors' growth (Jebelean's condition).
+        dlimb_t x0 = 1;
+        dlimb_t y0 = 0;
+        dlimb_t x1 = 0;
+        dlimb_t y1 = 1;
+        std::size_t steps = 0;
+        while (high_b != 0)
+        {
+            dlimb_t q = high_a / high_b;
+            if (q >> 64)
+            {
+                break;
+            }
+            dlimb_t r = high_a - q * high_b;
+            dlimb_t x2 = x0 + q * x1;
+            dlimb_t y2 = y0 + q * y1;
+            if ((x2 >> 64) || (y2 >> 64) || r < std::max(x2, y2)
+                || high_b - r < std::max(x1 + x2, y1 + y2))
+            {
+                break;
+            }
+            high_a = high_b;
+            high_b = r;
+            x0 = x1;
+            y0 = y1;
+            x1 = x2;
+            y1 = y2;
+            steps++;
+        }
+        if (steps == 0)
+        {
+            return false;
+        }
+
+        ScratchLimbs r = scratch(2 * (an + 1));
+        limb_t* ra = r.data();
+        limb_t* rb = ra + an + 1;
+        const bool negative_a = combine(ra, ap, an, static_cast<limb_t>(x0), bp, bn, static_cast<limb_t>(y0));
+        const bool negative_b = combine(rb, ap, an, static_cast<limb_t>(x1), bp, bn, static_cast<limb_t>(y1));
+        const std::size_t new_an = normalized_size(ra, an + 1);
+        const std::size_t new_bn = normalized_size(rb, an + 1);
+        if (cmp(ra, new_an, ap, an) >= 0 || cmp(rb, new_bn, ap, an) >= 0)
+        {
+            return false;
+        }
+        if (track)
+        {
+            BigInteger transform[2][2] = {
+                { signed_limb(static_cast<limb_t>(x0), negative_a), signed_limb(static_cast<limb_t>(y0), !negative_a) },
+                { signed_limb(static_cast<limb_t>(x1), negative_b), signed_limb(static_cast<limb_t>(y1), !negative_b) }
+            };
+            update(transform);
+        }
+        store(a, ra, new_an);
+        store(b, rb, new_bn);
+        if (a < b)
+        {
+            std::swap(a, b);
+            if (track)
+            {
+                std::swap(matrix[0][0], matrix[1][0]);
+                std::swap(matrix[0][1], matrix[1][1]);
+            }
+        }
+        return true;
+    }
+
+    // Replaces (a, b) with transform * (a, b) made nonnegative and ordered,
+    // unless that fails to shrink a.
+    bool GcdReduction::apply(BigInteger transform[2][2])
+    {
+        BigInteger next[2];
+        for (int i = 0; i < 2; i++)
+        {
+            next[i] = transform[i][0] * a;
+            next[i].addmul(transform[i][1], b);
+            if (next[i].is_negative())
+            {
+                next[i] = -std::move(next[i]);
+                transform[i][0] = -std::move(transform[i][0]);
+                transform[i][1] = -std::move(transform[i][1]);
+            }
+        }
+        if (next[0] < next[1])
+        {
+            std::swap(next[0], next[1]);
+            std::swap(transform[0][0], transform[1][0]);
+            std::swap(transform[0][1], transform[1][1]);
+        }
+        if (!(next[0] < a))
+        {
+            return false;
+        }
+        if (track)
+        {
+            update(transform);
+        }
+        a = std::move(next[0]);
+        b = std::move(next[1]);
+        return true;
+    }
+
+    // matrix = transform * matrix
+    void GcdReduction::update(BigInteger transform[2][2])
+    {
+        BigInteger product[2][2];
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < 2; j++)
+            {
+                product[i][j] = transform[i][0] * matrix[0][j];
+                product[i][j].addmul(transform[i][1], matrix[1][j]);
+            }
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < 2; j++)
+            {
+                matrix[i][j] = std::move(product[i][j]);
+            }
+        }
+    }
+}
+
+BigInteger gcd(const BigInteger& a, const BigInteger& b)
+{
+    BigInteger x = bigint_detail::GcdReduction::magnitude(a);
+    BigInteger y = bigint_detail::GcdReduction::magnitude(b);
+    if (x < y)
+    {
+        std::swap(x, y);
+    }
+    bigint_detail::GcdReduction reduction(std::move(x), std::move(y), false);
+    reduction.run();
+    return std::move(reduction.a);
+}
+
+BigInteger lcm(const BigInteger& a, const BigInteger& b)
+{
+    BigInteger divisor = gcd(a, b);
+    if (!divisor.is_positive())
+    {
+        return divisor;
+    }
+    return bigint_detail::GcdReduction::magnitude(a) / divisor * bigint_detail::GcdReduction::magnitude(b);
+}
+
+std::tuple<BigInteger, BigInteger, BigInteger> extended_gcd(const BigInteger& a, const BigInteger& b)
+{
+    BigInteger x = bigint_detail::GcdReduction::magnitude(a);
+    BigInteger y = bigint_detail::GcdReduction::magnitude(b);
+    const bool swapped = x < y;
+    if (swapped)
+    {
+        std::swap(x, y);
+    }
+    bigint_detail::GcdReduction reduction(std::move(x), std::move(y), true);
+    reduction.run();
+    BigInteger divisor = std::move(reduction.a);
+    if (!divisor.is_positive())
+    {
+        return std::make_tuple(BigInteger(0), BigInteger(0), BigInteger(0));
+    }
+    BigInteger coefficient = std::move(reduction.matrix[0][swapped ? 1 : 0]);
+    if (a.is_negative())
+    {
+        coefficient = -std::move(coefficient);
+    }
+    if (!b.is_positive() && !b.is_negative())
+    {
+        return std::make_tuple(std::move(divisor), std::move(coefficient), BigInteger(0));
+    }
+
+    // The least coefficient of a, from which the other follows exactly
+    BigInteger period = bigint_detail::GcdReduction::magnitude(b) / divisor;
+    coefficient %= period;
+    if (coefficient.is_negative())
+    {
+        coefficient += period;
+    }
+    if (coefficient + coefficient > period)
+    {
+        coefficient -= period;
+    }
+    BigInteger other = (divisor - a * coefficient) / b;
+    return std::make_tuple(std::move(divisor), std::move(coefficient), std::move(other));
+}
+
+BigInteger mod_inverse(const BigInteger& value, const BigInteger& modulus)
+{
+    BigInteger m = bigint_detail::GcdReduction::magnitude(modulus);
+    if (!m.is_positive())
+    {
+        throw std::invalid_argument("Cannot invert BigInteger modulo zero");
+    }
+    BigInteger residue = value % m;
+    if (residue.is_negative())
+    {
+        residue += m;
+    }
+    std::tuple<BigInteger, BigInteger, BigInteger> result = extended_gcd(residue, m);
+    if (std::get<0>(result) != BigInteger(1))
+    {
+        throw std::invalid_argument("Cannot invert BigInteger sharing a factor with the modulus");
+    }
+    BigInteger& inverse = std::get<1>(result);
+    if (inverse.is_negative())
+    {
+        inverse += m;
+    }
+    return std::move(inverse);
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+// Low-level limb kernels shared by the BigInteger translation units. These
+// work on raw little-endian limb arrays with explicit lengths so the higher
+// level algorithms can operate on sub-ranges without copying. Unless stated
+// otherwise the result may alias an input only when it starts at the same
+// address.
+
+#include "BigIntegerStats.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace bigint_detail
+{
+    typedef std::uint64_t limb_t;
+    typedef unsigned __int128 dlimb_t;
+
+    // Workspace for the multiplication, division and conversion algorithms
+    // comes from a per-thread pool, so repeated operations reuse blocks
+    // instead of going back to the global heap.
+    typedef std::pmr::vector<limb_t> ScratchLimbs;
+
+    std::pmr::memory_resource* scratch_resource();
+
+    inline ScratchLimbs scratch(std::size_t n)
+    {
+        return ScratchLimbs(n, scratch_resource());
+    }
+
+    inline ScratchLimbs scratch(const limb_t* first, const limb_t* last)
+    {
+        return ScratchLimbs(first, last, scratch_resource());
+    }
+
+    // Divides the two-limb value (high, low) by d where high < d, returning the
+    // quotient and storing the remainder.
+    inline limb_t div_2by1(limb_t high, limb_t low, limb_t d, limb_t& remainder)
+    {
+#if defined(__x86_64__)
+        limb_t quotient;
+        __asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(low), "d"(high), "rm"(d));
+        return quotient;
+#else
+        dlimb_t numerator = (static_cast<dlimb_t>(high) << 64) | low;
+        remainder = static_cast<limb_t>(numerator % d);
+        return static_cast<limb_t>(numerator / d);
+#endif
+    }
+
+    // Records one public operation on the calling thread: its time, the size
+    // of its larger operand in limbs and the first algorithm noted while it
+    // runs, which is the top-level choice. Compiles to nothing unless
+    // BIGINTEGER_INSTRUMENTATION is defined.
+#if defined(BIGINTEGER_INSTRUMENTATION)
+    class OperationScope
+    {
+        public:
+            OperationScope(BigIntegerOperation operation, std::size_t limbs);
+            ~OperationScope();
+            OperationScope(const OperationScope&) = delete;
+            OperationScope& operator=(const OperationScope&) = delete;
+
+        private:
+            friend void note_algorithm(BigIntegerAlgorithm algorithm);
+
+            BigIntegerOperation operation;
+            std::size_t limbs;
+            BigIntegerAlgorithm algorithm;
+            std::chrono::steady_clock::time_point start;
+            OperationScope* outer;
+    };
+
+    void note_algorithm(BigIntegerAlgorithm algorithm);
+#else
+    class OperationScope
+    {
+        public:
+            OperationScope(BigIntegerOperation, std::size_t)
+            {
+            }
+    };
+
+    inline void note_algorithm(BigIntegerAlgorithm)
+    {
+    }
+#endif
+
+    // Fork-join tasks on the shared work-stealing pool behind
+    // BigInteger::set_thread_count(). Tasks may run on any thread; wait()
+    // runs queued tasks itself until the group is done, so groups can nest
+    // freely. With a single thread run() executes the task immediately.
+    class TaskGroup
+    {
+        public:
+            TaskGroup();
+            ~TaskGroup();
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+
+            void run(std::function<void()> work);
+
+            // Blocks until every task has finished, then rethrows the first
+            // exception one of them threw.
+            void wait();
+
+            // Called by the pool when a task of this group ends.
+            void finish(std::exception_ptr failure);
+
+        private:
+            std::atomic<std::size_t> pending;
+            std::mutex mutex;
+            std::condition_variable done;
+            std::exception_ptr error;
+    };
+
+    // Whether operands of n limbs are worth splitting across threads.
+    bool worth_parallel(std::size_t n);
+
+    // Calls body on subranges of [begin, end) of at least grain elements,
+    // in parallel when more than one thread is available.
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain,
+                      const std::function<void(std::size_t, std::size_t)>& body);
+
+    // Instruction set used by add_n, sub_n, addmul_1, the logical kernels and
+    // popcount_n. The best path the CPU supports is picked on first use;
+    // set_kernel_path switches to another supported one (it is not thread
+    // safe) and returns false otherwise.
+    enum class KernelPath
+    {
+        scalar,
+        avx2,
+        avx512
+    };
+
+    bool kernel_path_supported(KernelPath path);
+    KernelPath kernel_path();
+    bool set_kernel_path(KernelPath path);
+
+#if defined(__x86_64__)
+    limb_t add_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    limb_t sub_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    limb_t add_n_avx512(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    limb_t sub_n_avx512(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    limb_t addmul_1_adx(limb_t* r, const limb_t* a, std::size_t n, limb_t b);
+    void and_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    void ior_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    void xor_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    void com_n_avx2(limb_t* r, const limb_t* a, std::size_t n);
+    std::size_t popcount_n_popcnt(const limb_t* a, std::size_t n);
+#endif
+
+    // Length of a with high zero limbs stripped.
+    std::size_t normalized_size(const limb_t* a, std::size_t n);
+
+    // Three-way comparison of two equal-length limb arrays.
+    int cmp_n(const limb_t* a, const limb_t* b, std::size_t n);
+
+    // Three-way comparison of two normalized limb arrays.
+    int cmp(const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // r = a + b over n limbs, returning the carry out.
+    limb_t add_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+
+    // r = a - b over n limbs, returning the borrow out.
+    limb_t sub_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+
+    // r = a + b where an >= bn; r has an limbs and the carry is returned.
+    limb_t add(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // r = a - b where an >= bn; r has an limbs and the borrow is returned.
+    limb_t sub(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // r = a + b for a single limb b, returning the carry out.
+    limb_t add_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b);
+
+    // r = a - b for a single limb b, returning the borrow out.
+    limb_t sub_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b);
+
+    // r = a * b, returning the high limb.
+    limb_t mul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b);
+
+    // r += a * b, returning the high limb.
+    limb_t addmul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b);
+
+    // r -= a * b, returning the high limb that still has to be subtracted.
+    limb_t submul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b);
+
+    // q = a / d, returning a % d. q may alias a.
+    limb_t divrem_1(limb_t* q, const limb_t* a, std::size_t n, limb_t d);
+
+    // r = a << bits for 0 < bits < 64, returning the bits shifted out. r may
+    // also start above a, for shifting in place by whole limbs as well.
+    limb_t lshift(limb_t* r, const limb_t* a, std::size_t n, unsigned bits);
+
+    // r = a >> bits for 0 < bits < 64, returning the bits shifted out in the
+    // high end of the limb. r may also start below a.
+    limb_t rshift(limb_t* r, const limb_t* a, std::size_t n, unsigned bits);
+
+    // r = a & b, a | b and a ^ b over n limbs.
+    void and_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    void ior_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+    void xor_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+
+    // r = ~a over n limbs.
+    void com_n(limb_t* r, const limb_t* a, std::size_t n);
+
+    // r = -a mod 2^(64n), the low n limbs of a's two's complement, returning
+    // 1 unless a is zero. Limbs below a's lowest set one stay zero, that one
+    // is negated and the rest are complemented.
+    limb_t neg_n(limb_t* r, const limb_t* a, std::size_t n);
+
+    // Number of set bits in a.
+    std::size_t popcount_n(const limb_t* a, std::size_t n);
+
+    // Quadratic product; r has an + bn limbs and must not overlap the inputs.
+    void mul_basecase(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // Karatsuba product for an >= bn > (an + 1) / 2.
+    void mul_karatsuba(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // Toom-Cook 3-way product for an >= bn.
+    void mul_toom3(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // Three-prime number-theoretic transform product; r has an + bn limbs.
+    void mul_ntt(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // Transform based square, needing a single forward transform; r has 2n limbs.
+    void sqr_ntt(limb_t* r, const limb_t* a, std::size_t n);
+
+    // Square with algorithm chosen by operand size; r has 2n limbs and must
+    // not overlap a.
+    void sqr(limb_t* r, const limb_t* a, std::size_t n);
+
+    // Product with algorithm chosen by operand size. r has an + bn limbs and
+    // must not overlap the inputs; either length may be zero. Identical
+    // operands are routed to sqr().
+    void mul(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // Knuth Algorithm D on a normalized divisor (top bit of v[vn - 1] set,
+    // vn >= 2) where the top vn limbs of u are below v. Writes un - vn
+    // quotient limbs to q and leaves the remainder in the low vn limbs of u.
+    void divrem_normalized(limb_t* q, limb_t* u, std::size_t un, const limb_t* v, std::size_t vn);
+
+    // Quotient and remainder of normalized a by normalized b with an >= bn >= 1.
+    // q has an - bn + 1 limbs and r has bn limbs; neither may overlap the
+    // inputs. Uses Knuth D or Burnikel-Ziegler depending on size.
+    void divrem(limb_t* q, limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn);
+
+    // 10^(19 * 2^k) from a cache shared by all conversions; references stay valid.
+    const std::vector<limb_t>& power_of_ten(std::size_t k);
+
+    // Writes a in decimal without leading zeros ("0" for zero) starting at
+    // out and advances it. Returns false if the digits do not fit before last.
+    bool write_decimal(const limb_t* a, std::size_t n, char*& out, char* last);
+
+    // Normalized limbs of a string of decimal digits (no sign); empty for zero.
+    std::vector<limb_t> parse_decimal(const char* digits, std::size_t length);
+
+    // r = a mod m for a normalized a of an limbs (possibly zero) and a
+    // normalized m of n limbs; r gets all n limbs, zero filled.
+    void residue(limb_t* r, const limb_t* a, std::size_t an, const limb_t* m, std::size_t n);
+
+    // Modular arithmetic on n-limb residues, keeping only constants inside
+    // so one reducer can be shared between threads. Products need a
+    // caller-supplied workspace of workspace_size() limbs and may write over
+    // their operands. Residues are kept in the reducer's own form: to_form()
+    // converts from an ordinary residue and from_form() back.
+
+    // Montgomery form a * R mod m, R = 2^(64n), for an odd modulus. Moduli
+    // from the Toom-3 threshold up reduce with two full products, which only
+    // beat the limb-by-limb reduction once products are well subquadratic. In
+    // constant-time mode every operation's timing and memory access pattern
+    // depend only on n.
+    class Montgomery
+    {
+        public:
+            Montgomery(const limb_t* m, std::size_t n, bool constant_time = false);
+
+            std::size_t size() const { return n; }
+            std::size_t workspace_size() const { return large ? 6 * n : 3 * n; }
+            const limb_t* one() const { return unit.data(); }
+
+            void to_form(limb_t* r, const limb_t* a, std::size_t an) const;
+            void from_form(limb_t* r, const limb_t* a, limb_t* workspace) const;
+            void mul(limb_t* r, const limb_t* a, const limb_t* b, limb_t* workspace) const;
+
+        private:
+            std::vector<limb_t> modulus;
+            std::vector<limb_t> inverse;
+            std::vector<limb_t> unit;
+            limb_t inverse_1;
+            std::size_t n;
+            bool constant_time;
+            bool large;
+
+            // r = t / R mod m for t < m * R; t has 2n limbs and is overwritten
+            void redc(limb_t* r, limb_t* t, limb_t* workspace) const;
+    };
+
+    // Reduction for any modulus against cached constants; the form is the
+    // ordinary residue. Below the Burnikel-Ziegler threshold this is Knuth's
+    // division by the pre-shifted modulus, above it Barrett reduction with
+    // floor(B^(2n) / m).
+    class Barrett
+    {
+        public:
+            Barrett(const limb_t* m, std::size_t n);
+
+            std::size_t size() const { return n; }
+            std::size_t workspace_size() const { return 6 * n + 5; }
+            const limb_t* one() const { return unit.data(); }
+
+            void to_form(limb_t* r, const limb_t* a, std::size_t an) const;
+            void from_form(limb_t* r, const limb_t* a, limb_t* workspace) const;
+            void mul(limb_t* r, const limb_t* a, const limb_t* b, limb_t* workspace) const;
+
+            // r = x mod m for x < B^(2n); x has 2n limbs and is overwritten
+            void reduce(limb_t* r, limb_t* x, limb_t* workspace) const;
+
+        private:
+            std::vector<limb_t> modulus;
+            std::vector<limb_t> normalized;
+            std::vector<limb_t> reciprocal;
+            std::vector<limb_t> unit;
+            std::size_t n;
+            unsigned shift;
+    };
+}
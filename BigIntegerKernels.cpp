@@ -0,0 +1,371 @@
+#include "BigIntegerInternal.h"
+
+namespace bigint_detail
+{
+    std::pmr::memory_resource* scratch_resource()
+    {
+        static thread_local std::pmr::unsynchronized_pool_resource pool(std::pmr::pool_options{ 0, 4 << 20 });
+        return &pool;
+    }
+
+    std::size_t normalized_size(const limb_t* a, std::size_t n)
+    {
+        while (n > 0 && a[n - 1] == 0)
+        {
+            n--;
+        }
+        return n;
+    }
+
+    int cmp_n(const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        for (std::size_t i = n; i-- > 0;)
+        {
+            if (a[i] != b[i])
+            {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    int cmp(const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        if (an != bn)
+        {
+            return an < bn ? -1 : 1;
+        }
+        return cmp_n(a, b, an);
+    }
+
+    static limb_t add_n_scalar(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            dlimb_t sum = static_cast<dlimb_t>(a[i]) + b[i] + carry;
+            r[i] = static_cast<limb_t>(sum);
+            carry = static_cast<limb_t>(sum >> 64);
+        }
+        return carry;
+    }
+
+    static limb_t sub_n_scalar(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        limb_t borrow = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            dlimb_t difference = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<limb_t>(difference);
+            borrow = static_cast<limb_t>(difference >> 64) & 1;
+        }
+        return borrow;
+    }
+
+    limb_t add_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b)
+    {
+        std::size_t i = 0;
+        for (; i < n && b; i++)
+        {
+            limb_t sum = a[i] + b;
+            b = sum < b;
+            r[i] = sum;
+        }
+        if (r != a)
+        {
+            for (; i < n; i++)
+            {
+                r[i] = a[i];
+            }
+        }
+        return b;
+    }
+
+    limb_t sub_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b)
+    {
+        std::size_t i = 0;
+        for (; i < n && b; i++)
+        {
+            limb_t difference = a[i] - b;
+            b = a[i] < b;
+            r[i] = difference;
+        }
+        if (r != a)
+        {
+            for (; i < n; i++)
+            {
+                r[i] = a[i];
+            }
+        }
+        return b;
+    }
+
+    limb_t add(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        limb_t carry = add_n(r, a, b, bn);
+        return add_1(r + bn, a + bn, an - bn, carry);
+    }
+
+    limb_t sub(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        limb_t borrow = sub_n(r, a, b, bn);
+        return sub_1(r + bn, a + bn, an - bn, borrow);
+    }
+
+    limb_t mul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b)
+    {
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            dlimb_t product = static_cast<dlimb_t>(a[i]) * b + carry;
+            r[i] = static_cast<limb_t>(product);
+            carry = static_cast<limb_t>(product >> 64);
+        }
+        return carry;
+    }
+
+    static limb_t addmul_1_scalar(limb_t* r, const limb_t* a, std::size_t n, limb_t b)
+    {
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            dlimb_t product = static_cast<dlimb_t>(a[i]) * b + r[i] + carry;
+            r[i] = static_cast<limb_t>(product);
+            carry = static_cast<limb_t>(product >> 64);
+        }
+        return carry;
+    }
+
+    static void and_n_scalar(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r[i] = a[i] & b[i];
+        }
+    }
+
+    static void ior_n_scalar(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r[i] = a[i] | b[i];
+        }
+    }
+
+    static void xor_n_scalar(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r[i] = a[i] ^ b[i];
+        }
+    }
+
+    static void com_n_scalar(limb_t* r, const limb_t* a, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r[i] = ~a[i];
+        }
+    }
+
+    static std::size_t popcount_n_scalar(const limb_t* a, std::size_t n)
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            count += static_cast<std::size_t>(__builtin_popcountll(a[i]));
+        }
+        return count;
+    }
+
+    // Kernels with instruction set specific versions go through this table,
+    // filled in on first use with the best path the CPU supports.
+    struct KernelTable
+    {
+        KernelPath path;
+        limb_t (*add_n)(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+        limb_t (*sub_n)(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+        limb_t (*addmul_1)(limb_t* r, const limb_t* a, std::size_t n, limb_t b);
+        void (*and_n)(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+        void (*ior_n)(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+        void (*xor_n)(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n);
+        void (*com_n)(limb_t* r, const limb_t* a, std::size_t n);
+        std::size_t (*popcount_n)(const limb_t* a, std::size_t n);
+    };
+
+    static KernelTable make_kernel_table(KernelPath path)
+    {
+        switch (path)
+        {
+#if defined(__x86_64__)
+            // The logical kernels are bound by memory bandwidth, so the
+            // wider registers of AVX-512 would gain nothing over AVX2.
+            case KernelPath::avx512:
+                return { path, add_n_avx512, sub_n_avx512, addmul_1_adx,
+                         and_n_avx2, ior_n_avx2, xor_n_avx2, com_n_avx2, popcount_n_popcnt };
+            case KernelPath::avx2:
+                return { path, add_n_avx2, sub_n_avx2, addmul_1_adx,
+                         and_n_avx2, ior_n_avx2, xor_n_avx2, com_n_avx2, popcount_n_popcnt };
+#endif
+            default:
+                return { KernelPath::scalar, add_n_scalar, sub_n_scalar, addmul_1_scalar,
+                         and_n_scalar, ior_n_scalar, xor_n_scalar, com_n_scalar, popcount_n_scalar };
+        }
+    }
+
+    static KernelTable& kernels()
+    {
+        static KernelTable table = make_kernel_table(
+            kernel_path_supported(KernelPath::avx512) ? KernelPath::avx512
+            : kernel_path_supported(KernelPath::avx2) ? KernelPath::avx2
+            : KernelPath::scalar);
+        return table;
+    }
+
+    bool kernel_path_supported(KernelPath path)
+    {
+        switch (path)
+        {
+            case KernelPath::scalar:
+                return true;
+#if defined(__x86_64__)
+            case KernelPath::avx2:
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx")
+                    && __builtin_cpu_supports("popcnt");
+            case KernelPath::avx512:
+                return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx")
+                    && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    KernelPath kernel_path()
+    {
+        return kernels().path;
+    }
+
+    bool set_kernel_path(KernelPath path)
+    {
+        if (!kernel_path_supported(path))
+        {
+            return false;
+        }
+        kernels() = make_kernel_table(path);
+        return true;
+    }
+
+    limb_t add_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        return kernels().add_n(r, a, b, n);
+    }
+
+    limb_t sub_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        return kernels().sub_n(r, a, b, n);
+    }
+
+    limb_t addmul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b)
+    {
+        return kernels().addmul_1(r, a, n, b);
+    }
+
+    void and_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        kernels().and_n(r, a, b, n);
+    }
+
+    void ior_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        kernels().ior_n(r, a, b, n);
+    }
+
+    void xor_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        kernels().xor_n(r, a, b, n);
+    }
+
+    void com_n(limb_t* r, const limb_t* a, std::size_t n)
+    {
+        kernels().com_n(r, a, n);
+    }
+
+    std::size_t popcount_n(const limb_t* a, std::size_t n)
+    {
+        return kernels().popcount_n(a, n);
+    }
+
+    limb_t neg_n(limb_t* r, const limb_t* a, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i < n && a[i] == 0; i++)
+        {
+            r[i] = 0;
+        }
+        if (i == n)
+        {
+            return 0;
+        }
+        r[i] = -a[i];
+        com_n(r + i + 1, a + i + 1, n - i - 1);
+        return 1;
+    }
+
+    limb_t submul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b)
+    {
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            dlimb_t product = static_cast<dlimb_t>(a[i]) * b + carry;
+            limb_t low = static_cast<limb_t>(product);
+            carry = static_cast<limb_t>(product >> 64) + (r[i] < low);
+            r[i] -= low;
+        }
+        return carry;
+    }
+
+    limb_t divrem_1(limb_t* q, const limb_t* a, std::size_t n, limb_t d)
+    {
+        limb_t remainder = 0;
+        for (std::size_t i = n; i-- > 0;)
+        {
+            q[i] = div_2by1(remainder, a[i], d, remainder);
+        }
+        return remainder;
+    }
+
+    limb_t lshift(limb_t* r, const limb_t* a, std::size_t n, unsigned bits)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        limb_t out = a[n - 1] >> (64 - bits);
+        for (std::size_t i = n - 1; i > 0; i--)
+        {
+            r[i] = (a[i] << bits) | (a[i - 1] >> (64 - bits));
+        }
+        r[0] = a[0] << bits;
+        return out;
+    }
+
+    limb_t rshift(limb_t* r, const limb_t* a, std::size_t n, unsigned bits)
+    {
+        limb_t out = n > 0 ? a[0] << (64 - bits) : 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r[i] = (a[i] >> bits) | (i + 1 < n ? a[i + 1] << (64 - bits) : 0);
+        }
+        return out;
+    }
+
+    void mul_basecase(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        r[an] = mul_1(r, a, an, b[0]);
+        for (std::size_t j = 1; j < bn; j++)
+        {
+            r[an + j] = addmul_1(r + j, a, an, b[j]);
+        }
+    }
+}
@@ -0,0 +1,327 @@
+#include "BigIntegerInternal.h"
+
+// x86-64 versions of the hot kernels, each compiled for its own instruction
+// set through target attributes so the rest of the library stays baseline.
+// BigIntegerKernels.cpp picks among them at run time.
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace bigint_detail
+{
+    // Carry-lookahead across the lanes of one vector. Bit i of generate is set
+    // when lane i overflowed, bit i of propagate when lane i is all ones (so an
+    // incoming carry passes through). Adding the shifted generate bits to the
+    // propagate bits ripples every carry through its run of propagating lanes
+    // in one integer addition; the bits that differ from propagate are the
+    // lanes receiving a carry. Returns that mask and updates carry to the carry
+    // out of the top lane.
+    static inline unsigned lookahead(unsigned generate, unsigned propagate, unsigned lanes, limb_t& carry)
+    {
+        unsigned sum = ((generate << 1) | static_cast<unsigned>(carry)) + propagate;
+        carry = sum >> lanes;
+        return (sum ^ propagate) & ((1u << lanes) - 1);
+    }
+
+    // Unsigned 64-bit a < b for AVX2, which only has signed compares.
+    __attribute__((target("avx2")))
+    static inline __m256i less_than_avx2(__m256i a, __m256i b)
+    {
+        const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(1ULL << 63));
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+    }
+
+    // All-ones in each lane whose bit is set in mask.
+    __attribute__((target("avx2")))
+    static inline __m256i lane_mask_avx2(unsigned mask)
+    {
+        const __m256i bits = _mm256_set_epi64x(8, 4, 2, 1);
+        __m256i selected = _mm256_and_si256(_mm256_set1_epi64x(mask), bits);
+        return _mm256_cmpeq_epi64(selected, bits);
+    }
+
+    __attribute__((target("avx2")))
+    static inline unsigned movemask_avx2(__m256i lanes)
+    {
+        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(lanes)));
+    }
+
+    __attribute__((target("avx2")))
+    limb_t add_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        const __m256i ones = _mm256_set1_epi64x(-1);
+        limb_t carry = 0;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i sum = _mm256_add_epi64(x, y);
+            unsigned generate = movemask_avx2(less_than_avx2(sum, x));
+            unsigned propagate = movemask_avx2(_mm256_cmpeq_epi64(sum, ones));
+            unsigned incoming = lookahead(generate, propagate, 4, carry);
+            // Subtracting an all-ones lane adds one
+            sum = _mm256_sub_epi64(sum, lane_mask_avx2(incoming));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), sum);
+        }
+        for (; i < n; i++)
+        {
+            dlimb_t sum = static_cast<dlimb_t>(a[i]) + b[i] + carry;
+            r[i] = static_cast<limb_t>(sum);
+            carry = static_cast<limb_t>(sum >> 64);
+        }
+        return carry;
+    }
+
+    __attribute__((target("avx2")))
+    limb_t sub_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        limb_t borrow = 0;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i difference = _mm256_sub_epi64(x, y);
+            unsigned generate = movemask_avx2(less_than_avx2(x, y));
+            unsigned propagate = movemask_avx2(_mm256_cmpeq_epi64(difference, zero));
+            unsigned incoming = lookahead(generate, propagate, 4, borrow);
+            // Adding an all-ones lane subtracts one
+            difference = _mm256_add_epi64(difference, lane_mask_avx2(incoming));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), difference);
+        }
+        for (; i < n; i++)
+        {
+            dlimb_t difference = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<limb_t>(difference);
+            borrow = static_cast<limb_t>(difference >> 64) & 1;
+        }
+        return borrow;
+    }
+
+    __attribute__((target("avx512f")))
+    limb_t add_n_avx512(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        const __m512i ones = _mm512_set1_epi64(-1);
+        const __m512i one = _mm512_set1_epi64(1);
+        limb_t carry = 0;
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m512i x = _mm512_loadu_si512(a + i);
+            __m512i y = _mm512_loadu_si512(b + i);
+            __m512i sum = _mm512_add_epi64(x, y);
+            unsigned generate = _mm512_cmplt_epu64_mask(sum, x);
+            unsigned propagate = _mm512_cmpeq_epu64_mask(sum, ones);
+            unsigned incoming = lookahead(generate, propagate, 8, carry);
+            sum = _mm512_mask_add_epi64(sum, static_cast<__mmask8>(incoming), sum, one);
+            _mm512_storeu_si512(r + i, sum);
+        }
+        if (i < n && i > 0)
+        {
+            // The tail of a long run goes through masked loads; short inputs
+            // are left to the scalar loop below
+            __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+            __m512i x = _mm512_maskz_loadu_epi64(tail, a + i);
+            __m512i y = _mm512_maskz_loadu_epi64(tail, b + i);
+            __m512i sum = _mm512_add_epi64(x, y);
+            unsigned generate = _mm512_cmplt_epu64_mask(sum, x);
+            unsigned propagate = _mm512_mask_cmpeq_epu64_mask(tail, sum, ones);
+            unsigned incoming = lookahead(generate, propagate, 8, carry);
+            sum = _mm512_mask_add_epi64(sum, static_cast<__mmask8>(incoming), sum, one);
+            _mm512_mask_storeu_epi64(r + i, tail, sum);
+            return (incoming >> (n - i)) & 1;
+        }
+        for (; i < n; i++)
+        {
+            dlimb_t sum = static_cast<dlimb_t>(a[i]) + b[i] + carry;
+            r[i] = static_cast<limb_t>(sum);
+            carry = static_cast<limb_t>(sum >> 64);
+        }
+        return carry;
+    }
+
+    __attribute__((target("avx512f")))
+    limb_t sub_n_avx512(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        const __m512i zero = _mm512_setzero_si512();
+        const __m512i one = _mm512_set1_epi64(1);
+        limb_t borrow = 0;
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m512i x = _mm512_loadu_si512(a + i);
+            __m512i y = _mm512_loadu_si512(b + i);
+            __m512i difference = _mm512_sub_epi64(x, y);
+            unsigned generate = _mm512_cmplt_epu64_mask(x, y);
+            unsigned propagate = _mm512_cmpeq_epu64_mask(difference, zero);
+            unsigned incoming = lookahead(generate, propagate, 8, borrow);
+            difference = _mm512_mask_sub_epi64(difference, static_cast<__mmask8>(incoming), difference, one);
+            _mm512_storeu_si512(r + i, difference);
+        }
+        if (i < n && i > 0)
+        {
+            __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+            __m512i x = _mm512_maskz_loadu_epi64(tail, a + i);
+            __m512i y = _mm512_maskz_loadu_epi64(tail, b + i);
+            __m512i difference = _mm512_sub_epi64(x, y);
+            unsigned generate = _mm512_cmplt_epu64_mask(x, y);
+            unsigned propagate = _mm512_mask_cmpeq_epu64_mask(tail, difference, zero);
+            unsigned incoming = lookahead(generate, propagate, 8, borrow);
+            difference = _mm512_mask_sub_epi64(difference, static_cast<__mmask8>(incoming), difference, one);
+            _mm512_mask_storeu_epi64(r + i, tail, difference);
+            return (incoming >> (n - i)) & 1;
+        }
+        for (; i < n; i++)
+        {
+            dlimb_t difference = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<limb_t>(difference);
+            borrow = static_cast<limb_t>(difference >> 64) & 1;
+        }
+        return borrow;
+    }
+
+    // There is no vector 64x64->128 multiply, so addmul_1 forms four products
+    // with mulx, then makes two carry passes over them: one folds the high
+    // halves into the low halves and one adds the sums to r. The compiler
+    // picks the add-with-carry instructions for each pass.
+    __attribute__((target("bmi2,adx")))
+    limb_t addmul_1_adx(limb_t* r, const limb_t* a, std::size_t n, limb_t b)
+    {
+        limb_t carry = 0;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            unsigned long long high[4];
+            unsigned long long low[4];
+            low[0] = _mulx_u64(a[i], b, &high[0]);
+            low[1] = _mulx_u64(a[i + 1], b, &high[1]);
+            low[2] = _mulx_u64(a[i + 2], b, &high[2]);
+            low[3] = _mulx_u64(a[i + 3], b, &high[3]);
+
+            // low + shifted high + carry in, then + r
+            unsigned long long sum[4];
+            unsigned char c = _addcarryx_u64(0, low[0], carry, &sum[0]);
+            c = _addcarryx_u64(c, low[1], high[0], &sum[1]);
+            c = _addcarryx_u64(c, low[2], high[1], &sum[2]);
+            c = _addcarryx_u64(c, low[3], high[2], &sum[3]);
+            unsigned long long top = high[3] + c;
+
+            unsigned long long out;
+            unsigned char d = _addcarryx_u64(0, r[i], sum[0], &out);
+            r[i] = out;
+            d = _addcarryx_u64(d, r[i + 1], sum[1], &out);
+            r[i + 1] = out;
+            d = _addcarryx_u64(d, r[i + 2], sum[2], &out);
+            r[i + 2] = out;
+            d = _addcarryx_u64(d, r[i + 3], sum[3], &out);
+            r[i + 3] = out;
+            carry = top + d;
+        }
+        for (; i < n; i++)
+        {
+            dlimb_t product = static_cast<dlimb_t>(a[i]) * b + r[i] + carry;
+            r[i] = static_cast<limb_t>(product);
+            carry = static_cast<limb_t>(product >> 64);
+        }
+        return carry;
+    }
+
+    // Limb-wise logic for the AVX2 kernels below, four limbs to a vector
+    struct AndLimbs
+    {
+        __attribute__((target("avx2")))
+        __m256i operator()(__m256i x, __m256i y) const { return _mm256_and_si256(x, y); }
+        limb_t operator()(limb_t x, limb_t y) const { return x & y; }
+    };
+
+    struct IorLimbs
+    {
+        __attribute__((target("avx2")))
+        __m256i operator()(__m256i x, __m256i y) const { return _mm256_or_si256(x, y); }
+        limb_t operator()(limb_t x, limb_t y) const { return x | y; }
+    };
+
+    struct XorLimbs
+    {
+        __attribute__((target("avx2")))
+        __m256i operator()(__m256i x, __m256i y) const { return _mm256_xor_si256(x, y); }
+        limb_t operator()(limb_t x, limb_t y) const { return x ^ y; }
+    };
+
+    template <typename Op>
+    __attribute__((target("avx2")))
+    static inline void logic_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n, Op op)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), op(x, y));
+        }
+        for (; i < n; i++)
+        {
+            r[i] = op(a[i], b[i]);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void and_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        logic_n_avx2(r, a, b, n, AndLimbs());
+    }
+
+    __attribute__((target("avx2")))
+    void ior_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        logic_n_avx2(r, a, b, n, IorLimbs());
+    }
+
+    __attribute__((target("avx2")))
+    void xor_n_avx2(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n)
+    {
+        logic_n_avx2(r, a, b, n, XorLimbs());
+    }
+
+    // Complement as an exclusive or with all ones
+    __attribute__((target("avx2")))
+    void com_n_avx2(limb_t* r, const limb_t* a, std::size_t n)
+    {
+        const __m256i ones = _mm256_set1_epi64x(-1);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_xor_si256(x, ones));
+        }
+        for (; i < n; i++)
+        {
+            r[i] = ~a[i];
+        }
+    }
+
+    // The popcnt instruction in place of the baseline bit-twiddling fallback;
+    // two accumulators keep consecutive limbs independent.
+    __attribute__((target("popcnt")))
+    std::size_t popcount_n_popcnt(const limb_t* a, std::size_t n)
+    {
+        std::size_t even = 0;
+        std::size_t odd = 0;
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            even += static_cast<std::size_t>(__builtin_popcountll(a[i]));
+            odd += static_cast<std::size_t>(__builtin_popcountll(a[i + 1]));
+        }
+        if (i < n)
+        {
+            even += static_cast<std::size_t>(__builtin_popcountll(a[i]));
+        }
+        return even + odd;
+    }
+}
+
+#endif
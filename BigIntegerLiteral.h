@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "BigIntegerView.h"
+
+// Decimal constants converted while compiling:
+//
+//     constexpr BigIntegerView p = 57896044618658097711785492504343953926634992332820282019728792003956564819949_big;
+//     BigInteger r = x * p % m;
+//
+// The limbs of each distinct literal are a constant table in static storage
+// and the literal is a BigIntegerView of it, so using one does no work at
+// run time. A leading '-' applies the view's unary minus, which only flips
+// the sign. Anything but decimal digits and digit separators, such as 1.5_big
+// or 0x10_big, fails to compile. Use to_big_integer() where a BigInteger
+// itself is needed.
+
+namespace bigint_detail
+{
+    // Limbs of the decimal digits in [digits, digits + length), skipping
+    // digit separators: nineteen digits at a time, limbs = limbs * 10^k + chunk
+    template<std::size_t Capacity>
+    constexpr std::array<std::uint64_t, Capacity> parse_literal(const char* digits, std::size_t length)
+    {
+        std::array<std::uint64_t, Capacity> limbs{};
+        std::size_t i = 0;
+        while (i < length)
+        {
+            std::uint64_t chunk = 0;
+            std::uint64_t scale = 1;
+            for (std::size_t k = 0; k < 19 && i < length; i++)
+            {
+                if (digits[i] != '\'')
+                {
+                    chunk = chunk * 10 + static_cast<std::uint64_t>(digits[i] - '0');
+                    scale *= 10;
+                    k++;
+                }
+            }
+            std::uint64_t carry = chunk;
+            for (std::size_t j = 0; j < Capacity; j++)
+            {
+                const unsigned __int128 t = static_cast<unsigned __int128>(limbs[j]) * scale + carry;
+                limbs[j] = static_cast<std::uint64_t>(t);
+                carry = static_cast<std::uint64_t>(t >> 64);
+            }
+        }
+        return limbs;
+    }
+
+    template<char... Digits>
+    struct DecimalLiteral
+    {
+        static constexpr char DIGITS[] = { Digits... };
+
+        static_assert((((Digits >= '0' && Digits <= '9') || Digits == '\'') && ...),
+                      "_big literals take decimal digits only");
+        static_assert(sizeof...(Digits) == 1 || DIGITS[0] != '0',
+                      "_big literals cannot start with 0, which would read as octal");
+
+        // log2(10) < 3.322, so n digits need at most n * 3.322 / 64 + 1 limbs
+        static constexpr std::size_t CAPACITY = sizeof...(Digits) * 3322 / 64000 + 1;
+
+        static constexpr std::array<std::uint64_t, CAPACITY> LIMBS = parse_literal<CAPACITY>(DIGITS, sizeof...(Digits));
+
+        // Limbs up to the most significant nonzero one; zero keeps one limb
+        static constexpr std::size_t size()
+        {
+            std::size_t n = CAPACITY;
+            while (n > 1 && LIMBS[n - 1] == 0)
+            {
+                n--;
+            }
+            return n;
+        }
+    };
+}
+
+template<char... Digits>
+constexpr BigIntegerView operator""_big()
+{
+    typedef bigint_detail::DecimalLiteral<Digits...> Literal;
+    return BigIntegerView(Literal::LIMBS.data(), Literal::size(), false);
+}
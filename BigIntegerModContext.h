@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "BigInteger.h"
+
+namespace bigint_detail
+{
+    struct ModState;
+}
+
+// Arithmetic modulo one fixed modulus. The Barrett reciprocal, and for odd
+// moduli the Montgomery constants, are computed once when the context is
+// built, so every later reduction costs a couple of multiplications instead
+// of a division:
+//
+//     ModContext ring(modulus);
+//     for (BigInteger& x : values)
+//     {
+//         x = ring.mulmod(x, factor);
+//     }
+//
+// Results lie in [0, |modulus|); operands may be any BigInteger. A context is
+// immutable, so one can be shared between threads, and copies share the
+// precomputed constants.
+class ModContext
+{
+    public:
+        explicit ModContext(const BigInteger& modulus);
+
+        // |modulus|
+        const BigInteger& modulus() const;
+
+        BigInteger reduce(const BigInteger& value) const;
+
+        // Reduces count values in place, spreading them across threads when
+        // there are enough of them.
+        void reduce(BigInteger* values, std::size_t count) const;
+
+        BigInteger addmod(const BigInteger& a, const BigInteger& b) const;
+        BigInteger submod(const BigInteger& a, const BigInteger& b) const;
+        BigInteger mulmod(const BigInteger& a, const BigInteger& b) const;
+
+        // base^exponent for a non-negative exponent, as pow_mod()
+        BigInteger pow(const BigInteger& base, const BigInteger& exponent) const;
+
+        // x with value * x = 1 modulo the modulus; throws if value and the
+        // modulus share a factor.
+        BigInteger inverse(const BigInteger& value) const;
+
+    private:
+        std::shared_ptr<const bigint_detail::ModState> state;
+
+        // value as an n-limb residue in r
+        void load(const BigInteger& value, std::uint64_t* r) const;
+        BigInteger store(const std::uint64_t* r) const;
+};
@@ -0,0 +1,644 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include "BigIntegerModContext.h"
+#include "BigIntegerNumeric.h"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+// Modular exponentiation and ModContext. Odd moduli work in Montgomery form,
+// where reducing a product needs no division; even ones fall back to Barrett
+// reduction. The exponent is scanned left to right in sliding windows over a
+// table of odd powers, and every buffer is sized before the first
+// multiplication.
+
+namespace bigint_detail
+{
+    void residue(limb_t* r, const limb_t* a, std::size_t an, const limb_t* m, std::size_t n)
+    {
+        std::fill(r, r + n, 0);
+        if (cmp(a, an, m, n) < 0)
+        {
+            std::copy(a, a + an, r);
+            return;
+        }
+        ScratchLimbs quotient = scratch(an - n + 1);
+        divrem(quotient.data(), r, a, an, m, n);
+    }
+
+    // r = a - m if that does not go below zero or carry is set, else a,
+    // without branching on the limbs.
+    static void subtract_if_above(limb_t* r, const limb_t* a, limb_t carry, const limb_t* m, std::size_t n, limb_t* workspace)
+    {
+        limb_t borrow = sub_n(workspace, a, m, n);
+        limb_t mask = 0 - ((carry | (borrow ^ 1)) & 1);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r[i] = (workspace[i] & mask) | (a[i] & ~mask);
+        }
+    }
+
+    Montgomery::Montgomery(const limb_t* m, std::size_t n, bool constant_time)
+        : modulus(m, m + n), unit(n), n(n), constant_time(constant_time),
+          large(!constant_time && n >= BigInteger::thresholds().toom3)
+    {
+        // m * m = 1 mod 8 for odd m, and each Newton step doubles the
+        // correct low bits: 3, 6, 12, 24, 48, 96
+        limb_t x = m[0];
+        for (int i = 0; i < 5; i++)
+        {
+            x *= 2 - m[0] * x;
+        }
+        inverse_1 = 0 - x;
+
+        if (large)
+        {
+            // The same Newton step on limbs, x = x * (2 - m * x) mod B^k,
+            // then negated
+            inverse.assign(n, 0);
+            inverse[0] = x;
+            std::vector<limb_t> product(2 * n);
+            std::vector<limb_t> correction(n);
+            for (std::size_t k = 1; k < n;)
+            {
+                std::size_t next = std::min(2 * k, n);
+                bigint_detail::mul(product.data(), m, next, inverse.data(), k);
+                for (std::size_t i = 0; i < next; i++)
+                {
+                    correction[i] = ~product[i];
+                }
+                add_1(correction.data(), correction.data(), next, 3);
+                bigint_detail::mul(product.data(), inverse.data(), k, correction.data(), next);
+                std::copy(product.begin(), product.begin() + next, inverse.begin());
+                k = next;
+            }
+            for (limb_t& limb : inverse)
+            {
+                limb = ~limb;
+            }
+            add_1(inverse.data(), inverse.data(), n, 1);
+        }
+
+        const limb_t one = 1;
+        to_form(unit.data(), &one, 1);
+    }
+
+    void Montgomery::to_form(limb_t* r, const limb_t* a, std::size_t an) const
+    {
+        an = normalized_size(a, an);
+        ScratchLimbs shifted = scratch(n + an);
+        std::copy(a, a + an, shifted.begin() + n);
+        residue(r, shifted.data(), an ? n + an : 0, modulus.data(), n);
+    }
+
+    void Montgomery::from_form(limb_t* r, const limb_t* a, limb_t* workspace) const
+    {
+        limb_t* t = workspace;
+        std::copy(a, a + n, t);
+        std::fill(t + n, t + 2 * n, 0);
+        redc(r, t, workspace + 2 * n);
+    }
+
+    void Montgomery::mul(limb_t* r, const limb_t* a, const limb_t* b, limb_t* workspace) const
+    {
+        limb_t* t = workspace;
+        if (constant_time)
+        {
+            // The faster algorithms branch on intermediate signs
+            mul_basecase(t, a, n, b, n);
+        }
+        else
+        {
+            bigint_detail::mul(t, a, n, b, n);
+        }
+        redc(r, t, workspace + 2 * n);
+    }
+
+    void Montgomery::redc(limb_t* r, limb_t* t, limb_t* workspace) const
+    {
+        const limb_t* m = modulus.data();
+        limb_t carry;
+        if (large)
+        {
+            // q = -t / m mod R makes t + q * m a multiple of R
+            limb_t* q = workspace;
+            limb_t* qm = workspace + 2 * n;
+            bigint_detail::mul(q, t, n, inverse.data(), n);
+            bigint_detail::mul(qm, q, n, m, n);
+            carry = add_n(t, t, qm, 2 * n);
+        }
+        else
+        {
+            // One limb of t cleared per row. Each row's carry belongs n limbs
+            // up, past every limb a later row reads, so it is parked in the
+            // limb just cleared and added in at the end.
+            for (std::size_t i = 0; i < n; i++)
+            {
+                limb_t q = t[i] * inverse_1;
+                t[i] = addmul_1(t + i, m, n, q);
+            }
+            carry = add_n(t + n, t + n, t, n);
+        }
+        // t / R < 2m, so one conditional subtraction finishes
+        subtract_if_above(r, t + n, carry, m, n, workspace);
+    }
+
+    Barrett::Barrett(const limb_t* m, std::size_t n)
+        : modulus(m, m + n), normalized(m, m + n), unit(n), n(n),
+          shift(static_cast<unsigned>(__builtin_clzll(m[n - 1])))
+    {
+        if (shift)
+        {
+            lshift(normalized.data(), m, n, shift);
+        }
+        std::vector<limb_t> power(2 * n + 1);
+        power.back() = 1;
+        std::vector<limb_t> remainder(n);
+        reciprocal.resize(n + 2);
+        divrem(reciprocal.data(), remainder.data(), power.data(), power.size(), m, n);
+        reciprocal.resize(normalized_size(reciprocal.data(), reciprocal.size()));
+
+        const limb_t one = 1;
+        to_form(unit.data(), &one, 1);
+    }
+
+    void Barrett::to_form(limb_t* r, const limb_t* a, std::size_t an) const
+    {
+        residue(r, a, normalized_size(a, an), modulus.data(), n);
+    }
+
+    void Barrett::from_form(limb_t* r, const limb_t* a, limb_t*) const
+    {
+        std::copy(a, a + n, r);
+    }
+
+    void Barrett::mul(limb_t* r, const limb_t* a, const limb_t* b, limb_t* workspace) const
+    {
+        limb_t* t = workspace;
+        bigint_detail::mul(t, a, n, b, n);
+        reduce(r, t, workspace + 2 * n);
+    }
+
+    void Barrett::reduce(limb_t* r, limb_t* x, limb_t* workspace) const
+    {
+        const limb_t* m = modulus.data();
+        if (n == 1)
+        {
+            r[0] = divrem_1(workspace, x, 2, m[0]);
+            return;
+        }
+        if (n < BigInteger::thresholds().burnikel_ziegler)
+        {
+            // Schoolbook division against the pre-shifted modulus does about
+            // as many limb products as the two below and runs faster
+            limb_t* u = workspace;
+            limb_t* quotient = workspace + 2 * n + 1;
+            u[2 * n] = shift ? lshift(u, x, 2 * n, shift) : 0;
+            if (!shift)
+            {
+                std::copy(x, x + 2 * n, u);
+            }
+            divrem_normalized(quotient, u, 2 * n + 1, normalized.data(), n);
+            if (shift)
+            {
+                rshift(r, u, n, shift);
+            }
+            else
+            {
+                std::copy(u, u + n, r);
+            }
+            return;
+        }
+
+        // The quotient estimate floor(floor(x / B^(n-1)) * mu / B^(n+1)) is
+        // at most two below the true one, and only the low n + 1 limbs of
+        // x - estimate * m matter
+        const std::size_t rn = reciprocal.size();
+        limb_t* estimate = workspace;
+        limb_t* product = workspace + (n + 1) + rn;
+        bigint_detail::mul(estimate, x + n - 1, n + 1, reciprocal.data(), rn);
+        bigint_detail::mul(product, estimate + n + 1, rn, m, n);
+        sub_n(x, x, product, n + 1);
+        while (x[n] != 0 || cmp_n(x, m, n) >= 0)
+        {
+            x[n] -= sub_n(x, x, m, n);
+        }
+        std::copy(x, x + n, r);
+    }
+
+    // Window width for a sliding-window exponent of the given bit length
+    static unsigned window_bits(std::size_t bits)
+    {
+        return bits > 1791 ? 7 : bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+    }
+
+    static unsigned exponent_bit(const limb_t* e, std::size_t i)
+    {
+        return static_cast<unsigned>(e[i / 64] >> (i % 64)) & 1;
+    }
+
+    // r = base^e mod m for an ordinary residue base and a normalized e
+    template<typename Reducer>
+    static void power_sliding(const Reducer& reducer, limb_t* r, const limb_t* base, const limb_t* e, std::size_t en)
+    {
+        const std::size_t n = reducer.size();
+        const std::size_t bits = en ? 64 * en - static_cast<std::size_t>(__builtin_clzll(e[en - 1])) : 0;
+        const unsigned window = window_bits(bits);
+        const std::size_t entries = std::size_t(1) << (window - 1);
+
+        // Odd powers base^1, base^3, ..., then the running value and the
+        // reducer's workspace, all in one block
+        ScratchLimbs buffer = scratch((entries + 2) * n + reducer.workspace_size());
+        limb_t* table = buffer.data();
+        limb_t* x = table + entries * n;
+        limb_t* square = x + n;
+        limb_t* workspace = square + n;
+
+        reducer.to_form(table, base, n);
+        if (entries > 1)
+        {
+            reducer.mul(square, table, table, workspace);
+            for (std::size_t k = 1; k < entries; k++)
+            {
+                reducer.mul(table + k * n, table + (k - 1) * n, square, workspace);
+            }
+        }
+
+        std::copy(reducer.one(), reducer.one() + n, x);
+        bool started = false;
+        std::size_t i = bits;
+        while (i > 0)
+        {
+            if (!exponent_bit(e, i - 1))
+            {
+                if (started)
+                {
+                    reducer.mul(x, x, x, workspace);
+                }
+                i--;
+                continue;
+            }
+            // The longest window from bit i - 1 down that ends in a one
+            std::size_t low = i > window ? i - window : 0;
+            while (!exponent_bit(e, low))
+            {
+                low++;
+            }
+            std::size_t value = 0;
+            for (std::size_t j = i; j > low; j--)
+            {
+                value = 2 * value + exponent_bit(e, j - 1);
+                if (started)
+                {
+                    reducer.mul(x, x, x, workspace);
+                }
+            }
+            const limb_t* odd_power = table + (value / 2) * n;
+            if (started)
+            {
+                reducer.mul(x, x, odd_power, workspace);
+            }
+            else
+            {
+                std::copy(odd_power, odd_power + n, x);
+                started = true;
+            }
+            i = low;
+        }
+        reducer.from_form(r, x, workspace);
+    }
+
+    // Fixed four-bit windows over every limb of e, each table entry read
+    // through a mask, so neither the sequence of operations nor the memory
+    // touched depends on the exponent's bits
+    static void power_fixed(const Montgomery& reducer, limb_t* r, const limb_t* base, const limb_t* e, std::size_t en)
+    {
+        const std::size_t n = reducer.size();
+        const std::size_t entries = 16;
+        ScratchLimbs buffer = scratch((entries + 2) * n + reducer.workspace_size());
+        limb_t* table = buffer.data();
+        limb_t* x = table + entries * n;
+        limb_t* selected = x + n;
+        limb_t* workspace = selected + n;
+
+        std::copy(reducer.one(), reducer.one() + n, table);
+        reducer.to_form(table + n, base, n);
+        for (std::size_t k = 2; k < entries; k++)
+        {
+            reducer.mul(table + k * n, table + (k - 1) * n, table + n, workspace);
+        }
+
+        auto select = [&](limb_t* out, std::size_t digit)
+        {
+            limb_t index = static_cast<limb_t>((e[digit / 16] >> (4 * (digit % 16))) & 15);
+            std::fill(out, out + n, 0);
+            for (std::size_t k = 0; k < entries; k++)
+            {
+                limb_t difference = static_cast<limb_t>(k) ^ index;
+                limb_t mask = ((difference | (0 - difference)) >> 63) - 1;
+                for (std::size_t j = 0; j < n; j++)
+                {
+                    out[j] |= table[k * n + j] & mask;
+                }
+            }
+        };
+
+        std::size_t digits = 16 * en;
+        select(x, digits - 1);
+        for (std::size_t d = digits - 1; d > 0; d--)
+        {
+            for (int s = 0; s < 4; s++)
+            {
+                reducer.mul(x, x, x, workspace);
+            }
+            select(selected, d - 1);
+            reducer.mul(x, x, selected, workspace);
+        }
+        reducer.from_form(r, x, workspace);
+    }
+}
+
+static void check_pow_mod(const BigInteger& exponent, const BigInteger& modulus)
+{
+    if (exponent.is_negative())
+    {
+        throw std::invalid_argument("Cannot raise BigInteger to a negative power");
+    }
+    if (!modulus.is_positive() && !modulus.is_negative())
+    {
+        throw std::invalid_argument("Cannot reduce BigInteger modulo zero");
+    }
+}
+
+// The base as a residue in [0, |m|), negative bases counting down from |m|
+static bigint_detail::ScratchLimbs base_residue(const LimbVector& base, bool negative, const LimbVector& m)
+{
+    const std::size_t n = m.size();
+    bigint_detail::ScratchLimbs residue = bigint_detail::scratch(n);
+    bigint_detail::residue(residue.data(), base.data(), bigint_detail::normalized_size(base.data(), base.size()), m.data(), n);
+    if (negative && bigint_detail::normalized_size(residue.data(), n) != 0)
+    {
+        bigint_detail::sub_n(residue.data(), m.data(), residue.data(), n);
+    }
+    return residue;
+}
+
+BigInteger pow_mod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus)
+{
+    if (base.number.empty() || exponent.number.empty() || modulus.number.empty())
+    {
+        throw std::invalid_argument("Cannot exponentiate uninitialized BigInteger");
+    }
+    check_pow_mod(exponent, modulus);
+    bigint_detail::OperationScope scope(BigIntegerOperation::pow_mod, modulus.number.size());
+    const LimbVector& m = modulus.number;
+    const LimbVector& e = exponent.number;
+    BigInteger result(0);
+    if (m.size() == 1 && m[0] == 1)
+    {
+        return result;
+    }
+    bigint_detail::ScratchLimbs residue = base_residue(base.number, base.negative, m);
+    const std::size_t en = bigint_detail::normalized_size(e.data(), e.size());
+    result.number.resize(m.size());
+    if (m[0] & 1)
+    {
+        bigint_detail::note_algorithm(BigIntegerAlgorithm::montgomery);
+        bigint_detail::Montgomery reducer(m.data(), m.size());
+        bigint_detail::power_sliding(reducer, result.number.data(), residue.data(), e.data(), en);
+    }
+    else
+    {
+        bigint_detail::note_algorithm(BigIntegerAlgorithm::barrett);
+        bigint_detail::Barrett reducer(m.data(), m.size());
+        bigint_detail::power_sliding(reducer, result.number.data(), residue.data(), e.data(), en);
+    }
+    result.normalize();
+    return result;
+}
+
+BigInteger pow_mod_secure(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus)
+{
+    if (base.number.empty() || exponent.number.empty() || modulus.number.empty())
+    {
+        throw std::invalid_argument("Cannot exponentiate uninitialized BigInteger");
+    }
+    check_pow_mod(exponent, modulus);
+    if (!(modulus.number[0] & 1))
+    {
+        throw std::invalid_argument("Cannot exponentiate BigInteger in constant time modulo an even number");
+    }
+    bigint_detail::OperationScope scope(BigIntegerOperation::pow_mod, modulus.number.size());
+    bigint_detail::note_algorithm(BigIntegerAlgorithm::montgomery);
+    const LimbVector& m = modulus.number;
+    BigInteger result(0);
+    if (m.size() == 1 && m[0] == 1)
+    {
+        return result;
+    }
+    bigint_detail::ScratchLimbs residue = base_residue(base.number, base.negative, m);
+    result.number.resize(m.size());
+    bigint_detail::Montgomery reducer(m.data(), m.size(), true);
+    bigint_detail::power_fixed(reducer, result.number.data(), residue.data(), exponent.number.data(), exponent.number.size());
+    result.normalize();
+    return result;
+}
+
+namespace bigint_detail
+{
+    struct ModState
+    {
+        ModState(const BigInteger& modulus, const limb_t* m, std::size_t n)
+            : modulus(modulus), limbs(m, m + n), barrett(m, n)
+        {
+            if (m[0] & 1)
+            {
+                montgomery.emplace(m, n);
+            }
+        }
+
+        // r = a mod m for a normalized a of any length. Longer values are
+        // folded in from the top n limbs at a time, each step a Barrett
+        // reduction of less than B^(2n).
+        void reduce(limb_t* r, const limb_t* a, std::size_t an) const
+        {
+            const std::size_t n = limbs.size();
+            std::fill(r, r + n, 0);
+            if (cmp(a, an, limbs.data(), n) < 0)
+            {
+                std::copy(a, a + an, r);
+                return;
+            }
+            ScratchLimbs buffer = scratch(2 * n + barrett.workspace_size());
+            limb_t* x = buffer.data();
+            limb_t* workspace = x + 2 * n;
+            std::size_t position = an > 2 * n ? an - 2 * n : 0;
+            std::copy(a + position, a + an, x);
+            std::fill(x + (an - position), x + 2 * n, 0);
+            barrett.reduce(r, x, workspace);
+            while (position > 0)
+            {
+                std::size_t length = std::min(n, position);
+                position -= length;
+                std::copy(a + position, a + position + length, x);
+                std::copy(r, r + n, x + length);
+                std::fill(x + length + n, x + 2 * n, 0);
+                barrett.reduce(r, x, workspace);
+            }
+        }
+
+        BigInteger modulus;
+        std::vector<limb_t> limbs;
+        Barrett barrett;
+        std::optional<Montgomery> montgomery;
+    };
+}
+
+ModContext::ModContext(const BigInteger& modulus)
+{
+    if (modulus.number.empty())
+    {
+        throw std::invalid_argument("Cannot build a modular context from an uninitialized BigInteger");
+    }
+    if (!modulus.is_positive() && !modulus.is_negative())
+    {
+        throw std::invalid_argument("Cannot reduce BigInteger modulo zero");
+    }
+    BigInteger magnitude = modulus.is_negative() ? -modulus : modulus;
+    state = std::make_shared<const bigint_detail::ModState>(magnitude, magnitude.number.data(), magnitude.number.size());
+}
+
+const BigInteger& ModContext::modulus() const
+{
+    return state->modulus;
+}
+
+void ModContext::load(const BigInteger& value, std::uint64_t* r) const
+{
+    if (value.number.empty())
+    {
+        throw std::invalid_argument("Cannot reduce uninitialized BigInteger");
+    }
+    const std::size_t n = state->limbs.size();
+    state->reduce(r, value.number.data(), bigint_detail::normalized_size(value.number.data(), value.number.size()));
+    if (value.negative && bigint_detail::normalized_size(r, n) != 0)
+    {
+        bigint_detail::sub_n(r, state->limbs.data(), r, n);
+    }
+}
+
+BigInteger ModContext::store(const std::uint64_t* r) const
+{
+    BigInteger result(0);
+    const std::size_t size = bigint_detail::normalized_size(r, state->limbs.size());
+    result.number.assign(r, r + std::max<std::size_t>(size, 1));
+    return result;
+}
+
+BigInteger ModContext::reduce(const BigInteger& value) const
+{
+    bigint_detail::ScratchLimbs r = bigint_detail::scratch(state->limbs.size());
+    load(value, r.data());
+    return store(r.data());
+}
+
+void ModContext::reduce(BigInteger* values, std::size_t count) const
+{
+    // Residues are worked out in parallel into one buffer, then written back
+    // on this thread, since the values' memory resources need not be thread
+    // safe
+    const std::size_t n = state->limbs.size();
+    bigint_detail::ScratchLimbs residues = bigint_detail::scratch(count * n);
+    const std::size_t grain = std::max<std::size_t>(BigInteger::thresholds().parallel / n, 1);
+    bigint_detail::parallel_for(0, count, grain, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; i++)
+        {
+            load(values[i], residues.data() + i * n);
+        }
+    });
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const std::uint64_t* r = residues.data() + i * n;
+        values[i].number.assign(r, r + std::max<std::size_t>(bigint_detail::normalized_size(r, n), 1));
+        values[i].negative = false;
+    }
+}
+
+BigInteger ModContext::addmod(const BigInteger& a, const BigInteger& b) const
+{
+    const std::size_t n = state->limbs.size();
+    bigint_detail::ScratchLimbs buffer = bigint_detail::scratch(3 * n);
+    load(a, buffer.data());
+    load(b, buffer.data() + n);
+    std::uint64_t carry = bigint_detail::add_n(buffer.data(), buffer.data(), buffer.data() + n, n);
+    bigint_detail::subtract_if_above(buffer.data(), buffer.data(), carry, state->limbs.data(), n, buffer.data() + 2 * n);
+    return store(buffer.data());
+}
+
+BigInteger ModContext::submod(const BigInteger& a, const BigInteger& b) const
+{
+    const std::size_t n = state->limbs.size();
+    bigint_detail::ScratchLimbs buffer = bigint_detail::scratch(2 * n);
+    load(a, buffer.data());
+    load(b, buffer.data() + n);
+    if (bigint_detail::sub_n(buffer.data(), buffer.data(), buffer.data() + n, n))
+    {
+        bigint_detail::add_n(buffer.data(), buffer.data(), state->limbs.data(), n);
+    }
+    return store(buffer.data());
+}
+
+BigInteger ModContext::mulmod(const BigInteger& a, const BigInteger& b) const
+{
+    const std::size_t n = state->limbs.size();
+    if (n == 1)
+    {
+        // Both residues are below m, so the product's high limb is too
+        std::uint64_t x;
+        std::uint64_t y;
+        load(a, &x);
+        load(b, &y);
+        bigint_detail::dlimb_t product = static_cast<bigint_detail::dlimb_t>(x) * y;
+        std::uint64_t r;
+        bigint_detail::div_2by1(static_cast<std::uint64_t>(product >> 64), static_cast<std::uint64_t>(product), state->limbs[0], r);
+        return store(&r);
+    }
+    const bigint_detail::Barrett& barrett = state->barrett;
+    bigint_detail::ScratchLimbs buffer = bigint_detail::scratch(2 * n + barrett.workspace_size());
+    load(a, buffer.data());
+    load(b, buffer.data() + n);
+    barrett.mul(buffer.data(), buffer.data(), buffer.data() + n, buffer.data() + 2 * n);
+    return store(buffer.data());
+}
+
+BigInteger ModContext::pow(const BigInteger& base, const BigInteger& exponent) const
+{
+    if (exponent.number.empty())
+    {
+        throw std::invalid_argument("Cannot exponentiate uninitialized BigInteger");
+    }
+    check_pow_mod(exponent, state->modulus);
+    bigint_detail::OperationScope scope(BigIntegerOperation::pow_mod, state->limbs.size());
+    const std::size_t n = state->limbs.size();
+    const LimbVector& e = exponent.number;
+    const std::size_t en = bigint_detail::normalized_size(e.data(), e.size());
+    bigint_detail::ScratchLimbs buffer = bigint_detail::scratch(2 * n);
+    load(base, buffer.data());
+    if (state->montgomery)
+    {
+        bigint_detail::note_algorithm(BigIntegerAlgorithm::montgomery);
+        bigint_detail::power_sliding(*state->montgomery, buffer.data() + n, buffer.data(), e.data(), en);
+    }
+    else
+    {
+        bigint_detail::note_algorithm(BigIntegerAlgorithm::barrett);
+        bigint_detail::power_sliding(state->barrett, buffer.data() + n, buffer.data(), e.data(), en);
+    }
+    return store(buffer.data() + n);
+}
+
+BigInteger ModContext::inverse(const BigInteger& value) const
+{
+    return mod_inverse(value, state->modulus);
+}
@@ -0,0 +1,358 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+#include <utility>
+
+namespace bigint_detail
+{
+    // Signed limb vector used while evaluating and interpolating Toom-Cook
+    // polynomials, where intermediate values can go negative.
+    struct SignedLimbs
+    {
+        ScratchLimbs magnitude = ScratchLimbs(scratch_resource());
+        bool negative = false;
+
+        SignedLimbs() = default;
+        SignedLimbs(SignedLimbs&&) = default;
+        SignedLimbs& operator=(SignedLimbs&&) = default;
+        SignedLimbs& operator=(const SignedLimbs&) = default;
+
+        // Copies stay in the scratch pool rather than the default resource
+        SignedLimbs(const SignedLimbs& other)
+            : magnitude(other.magnitude, scratch_resource()), negative(other.negative)
+        {
+        }
+    };
+
+    static SignedLimbs make_signed(const limb_t* a, std::size_t n)
+    {
+        SignedLimbs result;
+        result.magnitude.assign(a, a + normalized_size(a, n));
+        return result;
+    }
+
+    // Returns x + y, or x - y when subtract is set.
+    static SignedLimbs add_signed(const SignedLimbs& x, const SignedLimbs& y, bool subtract)
+    {
+        const bool y_negative = y.negative != subtract;
+        const ScratchLimbs& xm = x.magnitude;
+        const ScratchLimbs& ym = y.magnitude;
+        SignedLimbs result;
+        if (x.negative == y_negative)
+        {
+            const ScratchLimbs& longer = xm.size() >= ym.size() ? xm : ym;
+            const ScratchLimbs& shorter = xm.size() >= ym.size() ? ym : xm;
+            result.magnitude.resize(longer.size() + 1);
+            result.magnitude[longer.size()] = add(result.magnitude.data(), longer.data(), longer.size(),
+                                                  shorter.data(), shorter.size());
+            result.negative = x.negative;
+        }
+        else if (cmp(xm.data(), xm.size(), ym.data(), ym.size()) >= 0)
+        {
+            result.magnitude.resize(xm.size());
+            sub(result.magnitude.data(), xm.data(), xm.size(), ym.data(), ym.size());
+            result.negative = x.negative;
+        }
+        else
+        {
+            result.magnitude.resize(ym.size());
+            sub(result.magnitude.data(), ym.data(), ym.size(), xm.data(), xm.size());
+            result.negative = y_negative;
+        }
+        result.magnitude.resize(normalized_size(result.magnitude.data(), result.magnitude.size()));
+        if (result.magnitude.empty())
+        {
+            result.negative = false;
+        }
+        return result;
+    }
+
+    static void mul_small(SignedLimbs& x, limb_t factor)
+    {
+        limb_t carry = mul_1(x.magnitude.data(), x.magnitude.data(), x.magnitude.size(), factor);
+        if (carry)
+        {
+            x.magnitude.push_back(carry);
+        }
+    }
+
+    // Divides by a small factor that is known to divide x exactly.
+    static void div_exact_small(SignedLimbs& x, limb_t divisor)
+    {
+        divrem_1(x.magnitude.data(), x.magnitude.data(), x.magnitude.size(), divisor);
+        x.magnitude.resize(normalized_size(x.magnitude.data(), x.magnitude.size()));
+    }
+
+    // result = x * y, with result already sized to hold the product. Sizing
+    // happens up front on the calling thread, since the scratch pool behind
+    // the limbs belongs to that thread and the product may run on another.
+    static void mul_signed(SignedLimbs& result, const SignedLimbs& x, const SignedLimbs& y)
+    {
+        mul(result.magnitude.data(), x.magnitude.data(), x.magnitude.size(), y.magnitude.data(), y.magnitude.size());
+        result.magnitude.resize(normalized_size(result.magnitude.data(), result.magnitude.size()));
+        result.negative = !result.magnitude.empty() && x.negative != y.negative;
+    }
+
+    // Sets r = |x - y| for xn >= yn and returns whether x < y.
+    static bool abs_diff(limb_t* r, const limb_t* x, std::size_t xn, const limb_t* y, std::size_t yn)
+    {
+        bool x_smaller = normalized_size(x + yn, xn - yn) == 0 && cmp_n(x, y, yn) < 0;
+        if (x_smaller)
+        {
+            sub_n(r, y, x, yn);
+            std::fill(r + yn, r + xn, 0);
+        }
+        else
+        {
+            sub(r, x, xn, y, yn);
+        }
+        return x_smaller;
+    }
+
+    void mul_karatsuba(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        // a = a1 * B^h + a0, b = b1 * B^h + b0 with the low halves h limbs long
+        const std::size_t h = (an + 1) / 2;
+        const std::size_t a1n = an - h;
+        const std::size_t b1n = bn - h;
+        const limb_t* a1 = a + h;
+        const limb_t* b1 = b + h;
+
+        ScratchLimbs da = scratch(h);
+        ScratchLimbs db = scratch(h);
+        bool a_negative = abs_diff(da.data(), a, h, a1, a1n);
+        bool b_negative = abs_diff(db.data(), b, h, b1, b1n);
+
+        // z0 and z2 land directly in the low and high parts of the result.
+        // The three products are independent, so huge ones run in parallel.
+        ScratchLimbs zm = scratch(2 * h);
+        if (worth_parallel(h))
+        {
+            TaskGroup group;
+            group.run([&] { mul(r + 2 * h, a1, a1n, b1, b1n); });
+            group.run([&] { mul(zm.data(), da.data(), h, db.data(), h); });
+            mul(r, a, h, b, h);
+            group.wait();
+        }
+        else
+        {
+            mul(r, a, h, b, h);
+            mul(r + 2 * h, a1, a1n, b1, b1n);
+            mul(zm.data(), da.data(), h, db.data(), h);
+        }
+
+        // middle = z0 + z2 - (a0 - a1)(b0 - b1)
+        ScratchLimbs middle = scratch(2 * h + 1);
+        middle[2 * h] = add(middle.data(), r, 2 * h, r + 2 * h, a1n + b1n);
+        if (a_negative == b_negative)
+        {
+            sub(middle.data(), middle.data(), 2 * h + 1, zm.data(), 2 * h);
+        }
+        else
+        {
+            add(middle.data(), middle.data(), 2 * h + 1, zm.data(), 2 * h);
+        }
+        std::size_t middle_size = normalized_size(middle.data(), middle.size());
+        add(r + h, r + h, an + bn - h, middle.data(), middle_size);
+    }
+
+    void mul_toom3(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        // Split both operands into three k-limb pieces and evaluate the
+        // polynomials at 0, 1, -1, 2 and infinity.
+        const std::size_t k = (an + 2) / 3;
+        SignedLimbs a0 = make_signed(a, k);
+        SignedLimbs a1 = make_signed(a + k, std::min(k, an - k));
+        SignedLimbs a2 = make_signed(a + 2 * k, an - 2 * k);
+        SignedLimbs b0 = make_signed(b, std::min(k, bn));
+        SignedLimbs b1 = bn > k ? make_signed(b + k, std::min(k, bn - k)) : SignedLimbs();
+        SignedLimbs b2 = bn > 2 * k ? make_signed(b + 2 * k, bn - 2 * k) : SignedLimbs();
+
+        SignedLimbs a02 = add_signed(a0, a2, false);
+        SignedLimbs b02 = add_signed(b0, b2, false);
+        SignedLimbs pa1 = add_signed(a02, a1, false);
+        SignedLimbs pb1 = add_signed(b02, b1, false);
+        SignedLimbs pam1 = add_signed(a02, a1, true);
+        SignedLimbs pbm1 = add_signed(b02, b1, true);
+
+        // p(2) = ((2 * a2 + a1) * 2) + a0
+        SignedLimbs pa2 = a2;
+        mul_small(pa2, 2);
+        pa2 = add_signed(pa2, a1, false);
+        mul_small(pa2, 2);
+        pa2 = add_signed(pa2, a0, false);
+        SignedLimbs pb2 = b2;
+        mul_small(pb2, 2);
+        pb2 = add_signed(pb2, b1, false);
+        mul_small(pb2, 2);
+        pb2 = add_signed(pb2, b0, false);
+
+        SignedLimbs r0;
+        SignedLimbs r1;
+        SignedLimbs rm1;
+        SignedLimbs r2;
+        SignedLimbs rinf;
+        SignedLimbs* products[] = { &r0, &r1, &rm1, &r2, &rinf };
+        const SignedLimbs* left[] = { &a0, &pa1, &pam1, &pa2, &a2 };
+        const SignedLimbs* right[] = { &b0, &pb1, &pbm1, &pb2, &b2 };
+        for (std::size_t i = 0; i < 5; i++)
+        {
+            products[i]->magnitude.resize(left[i]->magnitude.size() + right[i]->magnitude.size());
+        }
+        if (worth_parallel(k))
+        {
+            // The five pointwise products are independent
+            TaskGroup group;
+            for (std::size_t i = 1; i < 5; i++)
+            {
+                group.run([&, i] { mul_signed(*products[i], *left[i], *right[i]); });
+            }
+            mul_signed(r0, a0, b0);
+            group.wait();
+        }
+        else
+        {
+            for (std::size_t i = 0; i < 5; i++)
+            {
+                mul_signed(*products[i], *left[i], *right[i]);
+            }
+        }
+
+        // Interpolate c(x) = c0 + c1 x + c2 x^2 + c3 x^3 + c4 x^4
+        SignedLimbs c0 = r0;
+        SignedLimbs c4 = rinf;
+        SignedLimbs even = add_signed(r1, rm1, false);  // 2 (c0 + c2 + c4)
+        div_exact_small(even, 2);
+        SignedLimbs odd = add_signed(r1, rm1, true);    // 2 (c1 + c3)
+        div_exact_small(odd, 2);
+        SignedLimbs c2 = add_signed(add_signed(even, c0, true), c4, true);
+
+        // (r2 - c0 - 4 c2 - 16 c4) / 2 = c1 + 4 c3
+        SignedLimbs scaled = c2;
+        mul_small(scaled, 4);
+        SignedLimbs high = c4;
+        mul_small(high, 16);
+        SignedLimbs e = add_signed(add_signed(add_signed(r2, c0, true), scaled, true), high, true);
+        div_exact_small(e, 2);
+        SignedLimbs c3 = add_signed(e, odd, true);
+        div_exact_small(c3, 3);
+        SignedLimbs c1 = add_signed(odd, c3, true);
+
+        const std::size_t total = an + bn;
+        std::fill(r, r + total, 0);
+        const SignedLimbs* coefficients[] = { &c0, &c1, &c2, &c3, &c4 };
+        for (std::size_t i = 0; i < 5; i++)
+        {
+            const ScratchLimbs& c = coefficients[i]->magnitude;
+            if (!c.empty())
+            {
+                add(r + i * k, r + i * k, total - i * k, c.data(), c.size());
+            }
+        }
+    }
+
+    // Splits the longer operand into bn-limb chunks so each partial product is
+    // balanced and can use the fast algorithms.
+    static void mul_unbalanced(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        const std::size_t total = an + bn;
+        std::fill(r, r + total, 0);
+        if (worth_parallel(bn))
+        {
+            // The even chunks' products do not overlap one another, and
+            // neither do the odd ones', so each set goes straight into its own
+            // buffer in parallel and the two are added once.
+            ScratchLimbs odd = scratch(total);
+            TaskGroup group;
+            for (std::size_t offset = 0; offset < an; offset += bn)
+            {
+                std::size_t length = std::min(bn, an - offset);
+                limb_t* target = (offset / bn) % 2 == 0 ? r + offset : odd.data() + offset;
+                group.run([=] { mul(target, a + offset, length, b, bn); });
+            }
+            group.wait();
+            add(r, r, total, odd.data(), total);
+            return;
+        }
+        ScratchLimbs partial = scratch(2 * bn);
+        for (std::size_t offset = 0; offset < an; offset += bn)
+        {
+            std::size_t length = std::min(bn, an - offset);
+            mul(partial.data(), a + offset, length, b, bn);
+            add(r + offset, r + offset, total - offset, partial.data(), length + bn);
+        }
+    }
+
+    static void mul_dispatch(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        const BigIntegerThresholds& thresholds = BigInteger::thresholds();
+        if (bn < thresholds.karatsuba)
+        {
+            note_algorithm(BigIntegerAlgorithm::schoolbook);
+            mul_basecase(r, a, an, b, bn);
+        }
+        else if (bn >= thresholds.ntt)
+        {
+            note_algorithm(BigIntegerAlgorithm::ntt);
+            mul_ntt(r, a, an, b, bn);
+        }
+        else if (2 * bn <= an + 1)
+        {
+            note_algorithm(BigIntegerAlgorithm::unbalanced);
+            mul_unbalanced(r, a, an, b, bn);
+        }
+        else if (bn < thresholds.toom3)
+        {
+            note_algorithm(BigIntegerAlgorithm::karatsuba);
+            mul_karatsuba(r, a, an, b, bn);
+        }
+        else
+        {
+            note_algorithm(BigIntegerAlgorithm::toom3);
+            mul_toom3(r, a, an, b, bn);
+        }
+    }
+
+    void sqr(limb_t* r, const limb_t* a, std::size_t n)
+    {
+        if (n == 0)
+        {
+            return;
+        }
+        if (n >= BigInteger::thresholds().ntt)
+        {
+            note_algorithm(BigIntegerAlgorithm::ntt);
+            sqr_ntt(r, a, n);
+        }
+        else
+        {
+            mul_dispatch(r, a, n, a, n);
+        }
+    }
+
+    void mul(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        if (a == b && an == bn)
+        {
+            sqr(r, a, an);
+            return;
+        }
+        if (an < bn)
+        {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        if (bn == 0)
+        {
+            std::fill(r, r + an, 0);
+            return;
+        }
+        mul_dispatch(r, a, an, b, bn);
+    }
+}
+
+BigIntegerThresholds& BigInteger::thresholds()
+{
+    static BigIntegerThresholds values;
+    return values;
+}
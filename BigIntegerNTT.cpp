@@ -0,0 +1,359 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+
+// Number-theoretic transform multiplication. Each operand limb is one
+// coefficient; the cyclic convolution is computed modulo three primes of the
+// form c * 2^k + 1 below 2^62 and recombined with the Chinese remainder
+// theorem. Their product exceeds 2^184, which bounds every convolution
+// coefficient (at most n * 2^128) for any transform length up to 2^55, so the
+// result is exact.
+
+namespace bigint_detail
+{
+    namespace
+    {
+        // Arithmetic modulo an odd prime below 2^62 with values kept in
+        // Montgomery form (x * 2^64 mod p).
+        class Montgomery
+        {
+            public:
+                limb_t p;
+                limb_t generator;
+
+                Montgomery(limb_t modulus, limb_t root)
+                    : p(modulus), generator(root)
+                {
+                    // Newton iteration doubles the correct low bits of p^-1 each step
+                    limb_t inverse = modulus;
+                    for (int i = 0; i < 5; i++)
+                    {
+                        inverse *= 2 - modulus * inverse;
+                    }
+                    negative_inverse = 0 - inverse;
+                    limb_t r = static_cast<limb_t>((static_cast<dlimb_t>(1) << 64) % modulus);
+                    r_squared = static_cast<limb_t>(static_cast<dlimb_t>(r) * r % modulus);
+                }
+
+                limb_t mul(limb_t a, limb_t b) const
+                {
+                    dlimb_t t = static_cast<dlimb_t>(a) * b;
+                    limb_t m = static_cast<limb_t>(t) * negative_inverse;
+                    limb_t u = static_cast<limb_t>((t + static_cast<dlimb_t>(m) * p) >> 64);
+                    return u >= p ? u - p : u;
+                }
+
+                limb_t add(limb_t a, limb_t b) const
+                {
+                    limb_t sum = a + b;
+                    return sum >= p ? sum - p : sum;
+                }
+
+                limb_t sub(limb_t a, limb_t b) const
+                {
+                    return a >= b ? a - b : a - b + p;
+                }
+
+                // Any 64-bit value to Montgomery form.
+                limb_t to_montgomery(limb_t x) const
+                {
+                    return mul(x, r_squared);
+                }
+
+                limb_t pow(limb_t base, limb_t exponent) const
+                {
+                    limb_t result = to_montgomery(1);
+                    while (exponent)
+                    {
+                        if (exponent & 1)
+                        {
+                            result = mul(result, base);
+                        }
+                        base = mul(base, base);
+                        exponent >>= 1;
+                    }
+                    return result;
+                }
+
+                // Plain x^-1 mod p.
+                limb_t inverse(limb_t x) const
+                {
+                    return mul(pow(to_montgomery(x), p - 2), 1);
+                }
+
+            private:
+                limb_t negative_inverse;
+                limb_t r_squared;
+        };
+
+        struct NttPrimes
+        {
+            Montgomery primes[3] = {
+                Montgomery(4179340454199820289ULL, 3),  // 29 * 2^57 + 1
+                Montgomery(2485986994308513793ULL, 5),  // 69 * 2^55 + 1
+                Montgomery(1945555039024054273ULL, 5),  // 27 * 2^56 + 1
+            };
+
+            // Garner constants, in Montgomery form of the prime they are used with
+            limb_t inverse_p0_mod_p1;
+            limb_t p0_mod_p2;
+            limb_t inverse_p0p1_mod_p2;
+            dlimb_t p0p1;
+
+            NttPrimes()
+            {
+                const Montgomery& m0 = primes[0];
+                const Montgomery& m1 = primes[1];
+                const Montgomery& m2 = primes[2];
+                inverse_p0_mod_p1 = m1.to_montgomery(m1.inverse(m0.p % m1.p));
+                p0_mod_p2 = m2.to_montgomery(m0.p % m2.p);
+                limb_t p0p1_mod_p2 = static_cast<limb_t>(static_cast<dlimb_t>(m0.p) * m1.p % m2.p);
+                inverse_p0p1_mod_p2 = m2.to_montgomery(m2.inverse(p0p1_mod_p2));
+                p0p1 = static_cast<dlimb_t>(m0.p) * m1.p;
+            }
+        };
+
+        const NttPrimes& ntt_primes()
+        {
+            static const NttPrimes primes;
+            return primes;
+        }
+
+        // Twiddle factors for every stage: table[len + j] = w^j where w is a
+        // primitive (2 len)-th root of unity, or its inverse.
+        ScratchLimbs make_roots(const Montgomery& m, std::size_t n, bool inverse)
+        {
+            ScratchLimbs table = scratch(std::max<std::size_t>(n, 2));
+            const limb_t one = m.to_montgomery(1);
+            const limb_t generator = m.to_montgomery(m.generator);
+            for (std::size_t len = 1; len < n; len <<= 1)
+            {
+                limb_t w = m.pow(generator, (m.p - 1) / (2 * len));
+                if (inverse)
+                {
+                    w = m.pow(w, m.p - 2);
+                }
+                table[len] = one;
+                for (std::size_t j = 1; j < len; j++)
+                {
+                    table[len + j] = m.mul(table[len + j - 1], w);
+                }
+            }
+            return table;
+        }
+
+        // Decimation in frequency: natural order in, bit-reversed order out.
+        void forward_transform(limb_t* a, std::size_t n, const Montgomery& m, const limb_t* roots)
+        {
+            for (std::size_t len = n / 2; len >= 1; len >>= 1)
+            {
+                for (std::size_t i = 0; i < n; i += 2 * len)
+                {
+                    for (std::size_t j = 0; j < len; j++)
+                    {
+                        limb_t u = a[i + j];
+                        limb_t v = a[i + j + len];
+                        a[i + j] = m.add(u, v);
+                        a[i + j + len] = m.mul(m.sub(u, v), roots[len + j]);
+                    }
+                }
+            }
+        }
+
+        // Decimation in time: bit-reversed order in, natural order out. The
+        // result is scaled by n.
+        void inverse_transform(limb_t* a, std::size_t n, const Montgomery& m, const limb_t* roots)
+        {
+            for (std::size_t len = 1; len < n; len <<= 1)
+            {
+                for (std::size_t i = 0; i < n; i += 2 * len)
+                {
+                    for (std::size_t j = 0; j < len; j++)
+                    {
+                        limb_t u = a[i + j];
+                        limb_t v = m.mul(a[i + j + len], roots[len + j]);
+                        a[i + j] = m.add(u, v);
+                        a[i + j + len] = m.sub(u, v);
+                    }
+                }
+            }
+        }
+
+        // Splits each butterfly stage across threads. After the first stage of
+        // a decimation in frequency transform its two halves are independent
+        // transforms of half the size using the same table, and the inverse
+        // runs that in reverse, so both recurse on the halves in parallel.
+        void butterflies(limb_t* a, std::size_t len, const Montgomery& m, const limb_t* roots, bool inverse)
+        {
+            parallel_for(0, len, BigInteger::thresholds().parallel, [=, &m](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t j = begin; j < end; j++)
+                {
+                    limb_t u = a[j];
+                    if (inverse)
+                    {
+                        limb_t v = m.mul(a[j + len], roots[len + j]);
+                        a[j] = m.add(u, v);
+                        a[j + len] = m.sub(u, v);
+                    }
+                    else
+                    {
+                        limb_t v = a[j + len];
+                        a[j] = m.add(u, v);
+                        a[j + len] = m.mul(m.sub(u, v), roots[len + j]);
+                    }
+                }
+            });
+        }
+
+        void transform(limb_t* a, std::size_t n, const Montgomery& m, const limb_t* roots, bool inverse)
+        {
+            if (!worth_parallel(n))
+            {
+                if (inverse)
+                {
+                    inverse_transform(a, n, m, roots);
+                }
+                else
+                {
+                    forward_transform(a, n, m, roots);
+                }
+                return;
+            }
+            const std::size_t half = n / 2;
+            if (!inverse)
+            {
+                butterflies(a, half, m, roots, false);
+            }
+            TaskGroup group;
+            group.run([=, &m] { transform(a + half, half, m, roots, inverse); });
+            transform(a, half, m, roots, inverse);
+            group.wait();
+            if (inverse)
+            {
+                butterflies(a, half, m, roots, true);
+            }
+        }
+
+        // Convolution of a and b (or of a with itself when b is null) modulo
+        // one prime, leaving plain residues in out[0..n).
+        void convolve(limb_t* out, std::size_t n, const Montgomery& m,
+                      const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+        {
+            for (std::size_t i = 0; i < an; i++)
+            {
+                out[i] = m.to_montgomery(a[i]);
+            }
+            std::fill(out + an, out + n, 0);
+            ScratchLimbs roots = make_roots(m, n, false);
+            transform(out, n, m, roots.data(), false);
+
+            const std::size_t grain = BigInteger::thresholds().parallel;
+            if (b)
+            {
+                ScratchLimbs other = scratch(n);
+                for (std::size_t i = 0; i < bn; i++)
+                {
+                    other[i] = m.to_montgomery(b[i]);
+                }
+                transform(other.data(), n, m, roots.data(), false);
+                const limb_t* factors = other.data();
+                parallel_for(0, n, grain, [=, &m](std::size_t begin, std::size_t end)
+                {
+                    for (std::size_t i = begin; i < end; i++)
+                    {
+                        out[i] = m.mul(out[i], factors[i]);
+                    }
+                });
+            }
+            else
+            {
+                parallel_for(0, n, grain, [=, &m](std::size_t begin, std::size_t end)
+                {
+                    for (std::size_t i = begin; i < end; i++)
+                    {
+                        out[i] = m.mul(out[i], out[i]);
+                    }
+                });
+            }
+
+            roots = make_roots(m, n, true);
+            transform(out, n, m, roots.data(), true);
+            // Multiplying by plain n^-1 both undoes the scaling and leaves
+            // Montgomery form.
+            const limb_t n_inverse = m.inverse(static_cast<limb_t>(n % m.p));
+            parallel_for(0, n, grain, [=, &m](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    out[i] = m.mul(out[i], n_inverse);
+                }
+            });
+        }
+
+        void ntt_product(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+        {
+            const std::size_t total = an + (b ? bn : an);
+            std::size_t n = 1;
+            while (n < total)
+            {
+                n <<= 1;
+            }
+
+            const NttPrimes& constants = ntt_primes();
+            ScratchLimbs residues[3] = { scratch(n), scratch(n), scratch(n) };
+            // One independent convolution per prime
+            {
+                TaskGroup group;
+                for (int k = 1; k < 3; k++)
+                {
+                    group.run([&, k] { convolve(residues[k].data(), n, constants.primes[k], a, an, b, bn); });
+                }
+                convolve(residues[0].data(), n, constants.primes[0], a, an, b, bn);
+                group.wait();
+            }
+
+            // Garner recombination of each coefficient into three limbs, then
+            // carry propagation into the result.
+            const Montgomery& m1 = constants.primes[1];
+            const Montgomery& m2 = constants.primes[2];
+            const limb_t p0 = constants.primes[0].p;
+            const limb_t p0p1_low = static_cast<limb_t>(constants.p0p1);
+            const limb_t p0p1_high = static_cast<limb_t>(constants.p0p1 >> 64);
+            limb_t carry[3] = { 0, 0, 0 };
+            for (std::size_t i = 0; i < total; i++)
+            {
+                limb_t v0 = residues[0][i];
+                limb_t v1 = m1.mul(m1.sub(residues[1][i], v0 % m1.p), constants.inverse_p0_mod_p1);
+                limb_t t = m2.sub(residues[2][i], v0 % m2.p);
+                t = m2.sub(t, m2.mul(v1 % m2.p, constants.p0_mod_p2));
+                limb_t v2 = m2.mul(t, constants.inverse_p0p1_mod_p2);
+
+                // x = v0 + v1 * p0 + v2 * p0 * p1
+                dlimb_t low = static_cast<dlimb_t>(v1) * p0 + v0;
+                dlimb_t high_low = static_cast<dlimb_t>(v2) * p0p1_low;
+                dlimb_t high_high = static_cast<dlimb_t>(v2) * p0p1_high;
+
+                dlimb_t sum = static_cast<dlimb_t>(static_cast<limb_t>(low)) + static_cast<limb_t>(high_low) + carry[0];
+                limb_t x0 = static_cast<limb_t>(sum);
+                sum = (sum >> 64) + static_cast<limb_t>(low >> 64) + static_cast<limb_t>(high_low >> 64)
+                    + static_cast<limb_t>(high_high) + carry[1];
+                carry[0] = static_cast<limb_t>(sum);
+                sum = (sum >> 64) + static_cast<limb_t>(high_high >> 64) + carry[2];
+                carry[1] = static_cast<limb_t>(sum);
+                carry[2] = static_cast<limb_t>(sum >> 64);
+                r[i] = x0;
+            }
+        }
+    }
+
+    void mul_ntt(limb_t* r, const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn)
+    {
+        ntt_product(r, a, an, b, bn);
+    }
+
+    void sqr_ntt(limb_t* r, const limb_t* a, std::size_t n)
+    {
+        ntt_product(r, a, n, nullptr, 0);
+    }
+}
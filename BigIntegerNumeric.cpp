@@ -0,0 +1,367 @@
+#include "BigIntegerNumeric.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace bigint_detail
+{
+    namespace
+    {
+        // Ranges are split into at most this many chunks per thread
+        const std::size_t CHUNKS_PER_THREAD = 4;
+
+        // acc[0, width) += a[0, an); the carry stops as soon as it dies, so
+        // one addition costs O(an) however wide the accumulator is.
+        void accumulate(limb_t* acc, std::size_t width, const limb_t* a, std::size_t an)
+        {
+            limb_t carry = add_n(acc, acc, a, an);
+            if (carry)
+            {
+                add_1(acc + an, acc + an, width - an, carry);
+            }
+        }
+    }
+}
+
+// Positive and negative magnitudes go into two accumulators one limb wider
+// than the largest value, which no count of additions can overflow, and are
+// subtracted once at the end.
+BigInteger bigint_detail::sum(const BigInteger* const* values, std::size_t count, BigIntegerExecution execution)
+{
+    std::size_t width = 1;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (values[i]->number.empty())
+        {
+            throw std::invalid_argument("Cannot add uninitialized BigInteger");
+        }
+        width = std::max(width, values[i]->number.size() + 1);
+    }
+
+    // Chunk c sums its share into partials[2c] (positive) and
+    // partials[2c + 1] (negative). The buffer is sized here, on the calling
+    // thread, since scratch memory is thread-affine.
+    std::size_t chunks = 1;
+    if (execution == BigIntegerExecution::parallel && worth_parallel(count * (width - 1)))
+    {
+        const std::size_t grain = std::max<std::size_t>(BigInteger::thresholds().parallel / (width - 1), 1);
+        chunks = std::min((count + grain - 1) / grain, CHUNKS_PER_THREAD * BigInteger::thread_count());
+    }
+    const std::size_t step = (count + chunks - 1) / std::max<std::size_t>(chunks, 1);
+    ScratchLimbs partials = scratch(2 * chunks * width);
+    std::fill(partials.begin(), partials.end(), 0);
+    parallel_for(0, chunks, 1, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t c = begin; c < end; c++)
+        {
+            limb_t* positive = partials.data() + 2 * c * width;
+            limb_t* negative = positive + width;
+            for (std::size_t i = c * step; i < std::min(count, (c + 1) * step); i++)
+            {
+                const LimbVector& limbs = values[i]->number;
+                accumulate(values[i]->negative ? negative : positive, width, limbs.data(), limbs.size());
+            }
+        }
+    });
+    limb_t* positive = partials.data();
+    limb_t* negative = positive + width;
+    for (std::size_t c = 1; c < chunks; c++)
+    {
+        accumulate(positive, width, partials.data() + 2 * c * width, width);
+        accumulate(negative, width, partials.data() + (2 * c + 1) * width, width);
+    }
+
+    BigInteger result(0);
+    const bool result_negative = cmp_n(positive, negative, width) < 0;
+    if (result_negative)
+    {
+        std::swap(positive, negative);
+    }
+    sub_n(positive, positive, negative, width);
+    const std::size_t size = normalized_size(positive, width);
+    result.number.assign(positive, positive + std::max<std::size_t>(size, 1));
+    result.negative = result_negative && size > 0;
+    return result;
+}
+
+namespace bigint_detail
+{
+    namespace
+    {
+        // Product of values[begin, end); prefix[i] is the limb count of the
+        // first i values. Halves are split by size rather than count, so each
+        // multiplication is close to balanced.
+        BigInteger product_tree(const BigInteger* const* values, const std::size_t* prefix, std::size_t begin,
+                                std::size_t end, bool parallel)
+        {
+            const std::size_t limbs = prefix[end] - prefix[begin];
+            if (end - begin <= 2 || limbs < BigInteger::thresholds().karatsuba)
+            {
+                BigInteger result = *values[begin];
+                for (std::size_t i = begin + 1; i < end; i++)
+                {
+                    result *= *values[i];
+                }
+                return result;
+            }
+            std::size_t mid = std::lower_bound(prefix + begin + 1, prefix + end, prefix[begin] + limbs / 2) - prefix;
+            mid = std::min(std::max(mid, begin + 1), end - 1);
+            BigInteger left;
+            BigInteger right;
+            if (parallel && worth_parallel(limbs / 2))
+            {
+                TaskGroup group;
+                group.run([&] { left = product_tree(values, prefix, begin, mid, parallel); });
+                right = product_tree(values, prefix, mid, end, parallel);
+                group.wait();
+            }
+            else
+            {
+                left = product_tree(values, prefix, begin, mid, parallel);
+                right = product_tree(values, prefix, mid, end, parallel);
+            }
+            return std::move(left) * right;
+        }
+    }
+}
+
+BigInteger bigint_detail::product(const BigInteger* const* values, std::size_t count, BigIntegerExecution execution)
+{
+    if (count == 0)
+    {
+        return BigInteger(1);
+    }
+    std::vector<std::size_t> prefix(count + 1, 0);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (values[i]->number.empty())
+        {
+            throw std::invalid_argument("Cannot multiply uninitialized BigInteger");
+        }
+        prefix[i + 1] = prefix[i] + values[i]->number.size();
+    }
+    return product_tree(values, prefix.data(), 0, count, execution == BigIntegerExecution::parallel);
+}
+
+// In parallel each chunk accumulates its own partial sum; the partials are
+// then added with sum().
+BigInteger bigint_detail::dot(const BigInteger* const* a, const BigInteger* const* b, std::size_t count,
+                              BigIntegerExecution execution)
+{
+    std::size_t limbs = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (a[i]->number.empty() || b[i]->number.empty())
+        {
+            throw std::invalid_argument("Cannot multiply uninitialized BigInteger");
+        }
+        limbs += a[i]->number.size() + b[i]->number.size();
+    }
+    std::size_t chunks = 1;
+    if (execution == BigIntegerExecution::parallel && worth_parallel(limbs))
+    {
+        chunks = std::min(count, CHUNKS_PER_THREAD * BigInteger::thread_count());
+    }
+    if (chunks <= 1)
+    {
+        BigInteger result(0);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            result.addmul(*a[i], *b[i]);
+        }
+        return result;
+    }
+    const std::size_t step = (count + chunks - 1) / chunks;
+    std::vector<BigInteger> partials(chunks, BigInteger(0));
+    parallel_for(0, chunks, 1, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t c = begin; c < end; c++)
+        {
+            for (std::size_t i = c * step; i < std::min(count, (c + 1) * step); i++)
+            {
+                partials[c].addmul(*a[i], *b[i]);
+            }
+        }
+    });
+    std::vector<const BigInteger*> pointers;
+    for (const BigInteger& partial : partials)
+    {
+        pointers.push_back(&partial);
+    }
+    return sum(pointers.data(), pointers.size(), BigIntegerExecution::sequential);
+}
+
+namespace bigint_detail
+{
+    namespace
+    {
+        // Primes up to n by a sieve over the odd numbers
+        std::vector<std::uint64_t> primes_up_to(std::uint64_t n)
+        {
+            std::vector<std::uint64_t> primes;
+            if (n < 2)
+            {
+                return primes;
+            }
+            primes.push_back(2);
+            // composite[i] marks 2i + 1
+            std::vector<bool> composite(static_cast<std::size_t>(n / 2 + 1), false);
+            for (std::uint64_t i = 1; 2 * i + 1 <= n; i++)
+            {
+                if (composite[i])
+                {
+                    continue;
+                }
+                const std::uint64_t p = 2 * i + 1;
+                primes.push_back(p);
+                if (p > n / p)
+                {
+                    continue;
+                }
+                for (std::uint64_t j = p * p / 2; 2 * j + 1 <= n; j += p)
+                {
+                    composite[j] = true;
+                }
+            }
+            return primes;
+        }
+
+        // Product of factors, several to a limb, along a product tree
+        BigInteger product_of(const std::vector<std::uint64_t>& factors)
+        {
+            std::vector<BigInteger> limbs;
+            std::uint64_t packed = 1;
+            for (std::uint64_t factor : factors)
+            {
+                if (static_cast<dlimb_t>(packed) * factor >> 64)
+                {
+                    limbs.emplace_back(packed);
+                    packed = 1;
+                }
+                packed *= factor;
+            }
+            limbs.emplace_back(packed);
+            std::vector<const BigInteger*> pointers;
+            for (const BigInteger& value : limbs)
+            {
+                pointers.push_back(&value);
+            }
+            return product(pointers.data(), pointers.size(), BigIntegerExecution::parallel);
+        }
+
+        // Product of primes[i]^exponents[i]: the primes with bit j of their
+        // exponent set form group j, and the groups are combined from the top
+        // bit down by squaring.
+        BigInteger from_factorization(const std::vector<std::uint64_t>& primes,
+                                      const std::vector<std::uint64_t>& exponents)
+        {
+            std::uint64_t combined = 0;
+            for (std::uint64_t exponent : exponents)
+            {
+                combined |= exponent;
+            }
+            BigInteger result(1);
+            for (int bit = 63; bit >= 0; bit--)
+            {
+                if (!(combined >> bit))
+                {
+                    continue;
+                }
+                std::vector<std::uint64_t> group;
+                for (std::size_t i = 0; i < primes.size(); i++)
+                {
+                    if ((exponents[i] >> bit) & 1)
+                    {
+                        group.push_back(primes[i]);
+                    }
+                }
+                result = result * result;
+                if (!group.empty())
+                {
+                    result *= product_of(group);
+                }
+            }
+            return result;
+        }
+
+        // Exponent of p in n!, by Legendre's formula
+        std::uint64_t legendre(std::uint64_t n, std::uint64_t p)
+        {
+            std::uint64_t exponent = 0;
+            while (n >= p)
+            {
+                n /= p;
+                exponent += n;
+            }
+            return exponent;
+        }
+    }
+}
+
+BigInteger factorial(std::uint64_t n)
+{
+    std::vector<std::uint64_t> primes = bigint_detail::primes_up_to(n);
+    std::vector<std::uint64_t> exponents;
+    for (std::uint64_t p : primes)
+    {
+        exponents.push_back(bigint_detail::legendre(n, p));
+    }
+    return bigint_detail::from_factorization(primes, exponents);
+}
+
+BigInteger binomial(std::uint64_t n, std::uint64_t k)
+{
+    if (k > n)
+    {
+        return BigInteger(0);
+    }
+    k = std::min(k, n - k);
+    if (k <= n / 16)
+    {
+        // Few factors: sieving up to n would cost more than one exact
+        // division of the falling factorial by k!
+        std::vector<std::uint64_t> falling;
+        for (std::uint64_t i = 0; i < k; i++)
+        {
+            falling.push_back(n - i);
+        }
+        return bigint_detail::product_of(falling) / factorial(k);
+    }
+    std::vector<std::uint64_t> primes = bigint_detail::primes_up_to(n);
+    std::vector<std::uint64_t> factors;
+    std::vector<std::uint64_t> exponents;
+    for (std::uint64_t p : primes)
+    {
+        std::uint64_t exponent = bigint_detail::legendre(n, p) - bigint_detail::legendre(k, p)
+                                 - bigint_detail::legendre(n - k, p);
+        if (exponent > 0)
+        {
+            factors.push_back(p);
+            exponents.push_back(exponent);
+        }
+    }
+    return bigint_detail::from_factorization(factors, exponents);
+}
+
+BigInteger primorial(std::uint64_t n)
+{
+    return bigint_detail::product_of(bigint_detail::primes_up_to(n));
+}
+
+BigInteger pow(const BigInteger& base, std::uint64_t exponent)
+{
+    BigInteger result(1);
+    for (int bit = 63; bit >= 0; bit--)
+    {
+        if (!(exponent >> bit))
+        {
+            continue;
+        }
+        result = result * result;
+        if ((exponent >> bit) & 1)
+        {
+            result *= base;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "BigInteger.h"
+
+// Aggregates over ranges, the BigInteger counterparts of std::accumulate and
+// std::inner_product:
+//
+//     BigInteger total = sum(values.begin(), values.end());
+//     BigInteger all = product(BigIntegerExecution::parallel, values.begin(), values.end());
+//
+// sum() adds every magnitude into one preallocated accumulator, product()
+// multiplies along a product tree balanced by operand size so the large
+// steps use the fast algorithms, and dot() accumulates through the fused
+// multiply-add. Ranges of other integer types are converted first.
+//
+// The combinatorial functions below work from the prime factorization of
+// their result: primes sharing an exponent bit are multiplied along a product
+// tree and the groups combined by repeated squaring, so nearly all the time
+// goes into a few large, balanced multiplications.
+
+// n!
+BigInteger factorial(std::uint64_t n);
+
+// n! / (k! (n - k)!), zero when k > n
+BigInteger binomial(std::uint64_t n, std::uint64_t k);
+
+// Product of the primes up to n
+BigInteger primorial(std::uint64_t n);
+
+// base^exponent by repeated squaring; pow(0, 0) is 1.
+BigInteger pow(const BigInteger& base, std::uint64_t exponent);
+
+// Greatest common divisor, never negative; gcd(0, 0) is 0. Binary GCD for
+// one or two limbs, Lehmer's algorithm above that and half-GCD from
+// thresholds().half_gcd limbs (see BigIntegerGCD.cpp).
+BigInteger gcd(const BigInteger& a, const BigInteger& b);
+
+// Least common multiple, never negative; zero if either argument is.
+BigInteger lcm(const BigInteger& a, const BigInteger& b);
+
+// (g, x, y) with a * x + b * y = g = gcd(a, b), taking the x of least
+// magnitude.
+std::tuple<BigInteger, BigInteger, BigInteger> extended_gcd(const BigInteger& a, const BigInteger& b);
+
+// x in [0, |modulus|) with value * x = 1 modulo modulus; throws if value and
+// the modulus share a factor.
+BigInteger mod_inverse(const BigInteger& value, const BigInteger& modulus);
+
+// floor(sqrt(value)); throws for a negative value.
+BigInteger isqrt(const BigInteger& value);
+
+// The k-th root rounded toward zero. Negative values need an odd k.
+BigInteger iroot(const BigInteger& value, std::uint64_t k);
+
+// Most non-squares are turned away by residues modulo small numbers before
+// any root is taken.
+bool is_perfect_square(const BigInteger& value);
+
+namespace bigint_detail
+{
+    template<typename Iterator>
+    constexpr bool is_big_integer_lvalue()
+    {
+        typedef typename std::iterator_traits<Iterator>::reference reference;
+        return std::is_lvalue_reference<reference>::value
+               && std::is_same<typename std::decay<reference>::type, BigInteger>::value;
+    }
+
+    // Pointers to the elements of [first, last). Elements that are not
+    // BigInteger lvalues are converted into storage, which must outlive the
+    // pointers.
+    template<typename Iterator>
+    void gather(Iterator first, Iterator last, std::vector<const BigInteger*>& pointers,
+                std::vector<BigInteger>& storage)
+    {
+        if constexpr (is_big_integer_lvalue<Iterator>())
+        {
+            for (; first != last; ++first)
+            {
+                pointers.push_back(&*first);
+            }
+        }
+        else
+        {
+            for (; first != last; ++first)
+            {
+                storage.emplace_back(*first);
+            }
+            for (const BigInteger& value : storage)
+            {
+                pointers.push_back(&value);
+            }
+        }
+    }
+
+    // As gather() for the count elements starting at first
+    template<typename Iterator>
+    void gather_n(Iterator first, std::size_t count, std::vector<const BigInteger*>& pointers,
+                  std::vector<BigInteger>& storage)
+    {
+        if constexpr (is_big_integer_lvalue<Iterator>())
+        {
+            for (std::size_t i = 0; i < count; i++, ++first)
+            {
+                pointers.push_back(&*first);
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < count; i++, ++first)
+            {
+                storage.emplace_back(*first);
+            }
+            for (const BigInteger& value : storage)
+            {
+                pointers.push_back(&value);
+            }
+        }
+    }
+}
+
+template<typename InputIt>
+BigInteger sum(BigIntegerExecution execution, InputIt first, InputIt last)
+{
+    std::vector<const BigInteger*> values;
+    std::vector<BigInteger> storage;
+    bigint_detail::gather(first, last, values, storage);
+    return bigint_detail::sum(values.data(), values.size(), execution);
+}
+
+template<typename InputIt>
+BigInteger sum(InputIt first, InputIt last)
+{
+    return sum(BigIntegerExecution::sequential, first, last);
+}
+
+template<typename InputIt>
+BigInteger product(BigIntegerExecution execution, InputIt first, InputIt last)
+{
+    std::vector<const BigInteger*> values;
+    std::vector<BigInteger> storage;
+    bigint_detail::gather(first, last, values, storage);
+    return bigint_detail::product(values.data(), values.size(), execution);
+}
+
+template<typename InputIt>
+BigInteger product(InputIt first, InputIt last)
+{
+    return product(BigIntegerExecution::sequential, first, last);
+}
+
+// Sum of a[i] * b[i] over [first1, last1) and the range starting at first2
+template<typename InputIt1, typename InputIt2>
+BigInteger dot(BigIntegerExecution execution, InputIt1 first1, InputIt1 last1, InputIt2 first2)
+{
+    std::vector<const BigInteger*> a;
+    std::vector<const BigInteger*> b;
+    std::vector<BigInteger> a_storage;
+    std::vector<BigInteger> b_storage;
+    bigint_detail::gather(first1, last1, a, a_storage);
+    bigint_detail::gather_n(first2, a.size(), b, b_storage);
+    return bigint_detail::dot(a.data(), b.data(), a.size(), execution);
+}
+
+template<typename InputIt1, typename InputIt2>
+BigInteger dot(InputIt1 first1, InputIt1 last1, InputIt2 first2)
+{
+    return dot(BigIntegerExecution::sequential, first1, last1, first2);
+}
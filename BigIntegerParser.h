@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BigInteger.h"
+
+// Incremental decimal parser for inputs too large to hold as one string.
+// Characters are fed in blocks of any size as they arrive:
+//
+//     BigIntegerParser parser;
+//     while (std::size_t n = read_some(buffer, sizeof(buffer)))
+//     {
+//         if (parser.feed(buffer, buffer + n) < n)
+//         {
+//             break;
+//         }
+//     }
+//     BigInteger value = parser.finish();
+//
+// Each full block of digits is converted to limbs at once and merged with
+// earlier blocks of the same size, like a binary counter, so parsing costs
+// the same O(M(n) log n) as converting a whole string while the digits
+// themselves are never stored: extra memory stays within a small multiple of
+// the result's size.
+class BigIntegerParser
+{
+    public:
+        BigIntegerParser();
+
+        // Takes as much of [first, last) as continues an optional '-' and
+        // digits and returns the number of characters taken. Taking fewer
+        // than given means the number ended; later calls then take nothing.
+        std::size_t feed(const char* first, const char* last);
+
+        // True once a character that cannot continue the number was seen
+        bool done() const;
+
+        // The parsed value; throws std::invalid_argument if no digits were
+        // fed. The parser is then ready for the next number.
+        BigInteger finish();
+
+        // Parses one number from a source that fills a buffer and returns
+        // the count written, zero at the end of input.
+        static BigInteger parse(const std::function<std::size_t(char* buffer, std::size_t size)>& source);
+
+    private:
+        // Digits per block: 19 * 2^BLOCK_LOG, a node of the power-of-ten tree
+        static const std::size_t BLOCK_LOG = 6;
+        static const std::size_t BLOCK_DIGITS = 19 << BLOCK_LOG;
+
+        struct Segment
+        {
+            // Normalized limbs of BLOCK_DIGITS * 2^level digits
+            std::vector<std::uint64_t> limbs;
+            std::size_t level;
+        };
+
+        std::vector<Segment> segments;
+        char block[BLOCK_DIGITS];
+        std::size_t pending;
+        std::size_t digits;
+        bool negative;
+        bool started;
+        bool stopped;
+
+        void push_block();
+        void reset();
+};
@@ -0,0 +1,198 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include "BigIntegerNumeric.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Integer roots by Newton's method with precision doubling: the root of the
+// top half of the bits, shifted into place, is already correct to half the
+// digits, so a single Newton step at full precision, plus a check, finishes
+// it. The steps at the lower levels shrink geometrically, and the whole root
+// costs a small multiple of one full-size division.
+
+namespace bigint_detail
+{
+    class Roots
+    {
+        public:
+            // floor(a^(1/k)) for a >= 0, k >= 2
+            static BigInteger root(const BigInteger& a, std::uint64_t k);
+
+            // False for most non-squares after a few single-limb residues
+            static bool maybe_square(const BigInteger& a);
+
+            static void check(const BigInteger& value, const char* message);
+
+        private:
+            static limb_t root_1(limb_t a, std::uint64_t k);
+    };
+
+    void Roots::check(const BigInteger& value, const char* message)
+    {
+        if (value.number.empty())
+        {
+            throw std::invalid_argument(message);
+        }
+    }
+
+    // Floating-point estimate, then exact correction in 128-bit arithmetic
+    limb_t Roots::root_1(limb_t a, std::uint64_t k)
+    {
+        if (a < 2 || k >= 64)
+        {
+            return a < 2 ? a : 1;
+        }
+        auto power_above = [a, k](limb_t x)
+        {
+            dlimb_t p = 1;
+            for (std::uint64_t i = 0; i < k; i++)
+            {
+                p *= x;
+                if (p > a)
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        limb_t x = static_cast<limb_t>(std::pow(static_cast<double>(a), 1.0 / static_cast<double>(k)));
+        while (x > 0 && power_above(x))
+        {
+            x--;
+        }
+        while (!power_above(x + 1))
+        {
+            x++;
+        }
+        return x;
+    }
+
+    BigInteger Roots::root(const BigInteger& a, std::uint64_t k)
+    {
+        if (a.number.size() == 1)
+        {
+            return BigInteger(root_1(a.number[0], k));
+        }
+        // a < 2^bits, so the root is 1 once k reaches bits
+        const std::size_t bits = a.bit_length();
+        if (k >= bits)
+        {
+            return BigInteger(1);
+        }
+        // An upper bound on the root: the root of the top bits, shifted back
+        // and rounded up, or a plain power of two for tiny roots. A few guard
+        // bits beyond half keep the Newton error below one, so the first
+        // step usually lands on the answer.
+        const std::size_t guard = 66 - __builtin_clzll(k);
+        const std::size_t shift = bits / (2 * k) > guard ? bits / (2 * k) - guard : 0;
+        BigInteger x;
+        if (shift == 0)
+        {
+            x = BigInteger(1) << (bits / k + (bits % k != 0));
+        }
+        else
+        {
+            x = (root(a >> k * shift, k) + BigInteger(1)) << shift;
+        }
+
+        // Newton from above never undershoots the floor of the root, so the
+        // first value whose power fits is the answer.
+        const BigInteger degree(k);
+        const BigInteger below(k - 1);
+        while (true)
+        {
+            BigInteger y = a / (k == 2 ? x : pow(x, k - 1));
+            y.addmul(below, x);
+            y /= degree;
+            if (!(y < x))
+            {
+                return x;
+            }
+            x = std::move(y);
+            if (!(a < (k == 2 ? x * x : pow(x, k))))
+            {
+                return x;
+            }
+        }
+    }
+
+    bool Roots::maybe_square(const BigInteger& a)
+    {
+        // Squares modulo 64, 63, 65 and 11, with 63 * 65 * 11 reduced in one
+        // pass over the limbs
+        static const struct Residues
+        {
+            bool mod64[64] = {};
+            bool mod63[63] = {};
+            bool mod65[65] = {};
+            bool mod11[11] = {};
+
+            Residues()
+            {
+                for (unsigned i = 0; i < 65; i++)
+                {
+                    mod64[i * i % 64] = true;
+                    mod63[i * i % 63] = true;
+                    mod65[i * i % 65] = true;
+                    mod11[i * i % 11] = true;
+                }
+            }
+        } residues;
+
+        if (!residues.mod64[a.number[0] % 64])
+        {
+            return false;
+        }
+        ScratchLimbs quotient = scratch(a.number.size());
+        const limb_t r = divrem_1(quotient.data(), a.number.data(), a.number.size(), 63 * 65 * 11);
+        return residues.mod63[r % 63] && residues.mod65[r % 65] && residues.mod11[r % 11];
+    }
+}
+
+BigInteger isqrt(const BigInteger& value)
+{
+    bigint_detail::Roots::check(value, "Cannot take the square root of uninitialized BigInteger");
+    if (value.is_negative())
+    {
+        throw std::invalid_argument("Cannot take the square root of negative BigInteger");
+    }
+    return bigint_detail::Roots::root(value, 2);
+}
+
+BigInteger iroot(const BigInteger& value, std::uint64_t k)
+{
+    bigint_detail::Roots::check(value, "Cannot take the root of uninitialized BigInteger");
+    if (k == 0)
+    {
+        throw std::invalid_argument("Cannot take the zeroth root of BigInteger");
+    }
+    if (k == 1)
+    {
+        return value;
+    }
+    if (value.is_negative())
+    {
+        if (k % 2 == 0)
+        {
+            throw std::invalid_argument("Cannot take an even root of negative BigInteger");
+        }
+        return -bigint_detail::Roots::root(-value, k);
+    }
+    return bigint_detail::Roots::root(value, k);
+}
+
+bool is_perfect_square(const BigInteger& value)
+{
+    bigint_detail::Roots::check(value, "Cannot take the square root of uninitialized BigInteger");
+    if (value.is_negative())
+    {
+        return false;
+    }
+    if (!bigint_detail::Roots::maybe_square(value))
+    {
+        return false;
+    }
+    BigInteger root = bigint_detail::Roots::root(value, 2);
+    return root * root == value;
+}
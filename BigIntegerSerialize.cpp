@@ -0,0 +1,280 @@
+#include "BigIntegerView.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Binary records and BigIntegerView. Encoding and decoding go byte by byte,
+// so records read the same on any machine; only the zero-copy view needs a
+// little-endian one.
+
+namespace
+{
+    const unsigned char MAGIC[4] = { 'B', 'I', 'G', 'I' };
+    const std::uint64_t ZERO_LIMB = 0;
+
+    void store_u64(unsigned char* out, std::uint64_t value)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            out[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    std::uint64_t load_u64(const unsigned char* in)
+    {
+        std::uint64_t value = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    struct Header
+    {
+        bool negative;
+        std::size_t count;
+    };
+
+    // Checks the record at first and returns its header; the limbs follow
+    // at first + BIGINTEGER_HEADER_SIZE.
+    Header read_header(const unsigned char* first, const unsigned char* last)
+    {
+        const std::size_t available = static_cast<std::size_t>(last - first);
+        if (available < BIGINTEGER_HEADER_SIZE || std::memcmp(first, MAGIC, 4) != 0)
+        {
+            throw std::invalid_argument("Cannot read BigInteger from data without a BigInteger header");
+        }
+        if (first[4] != BIGINTEGER_FORMAT_VERSION)
+        {
+            throw std::invalid_argument("Cannot read BigInteger of an unknown format version");
+        }
+        if (first[5] > 1 || first[6] != 0 || first[7] != 0)
+        {
+            throw std::invalid_argument("Cannot read BigInteger with unknown flags");
+        }
+        const std::uint64_t count = load_u64(first + 8);
+        if (count > (available - BIGINTEGER_HEADER_SIZE) / 8)
+        {
+            throw std::invalid_argument("Cannot read truncated BigInteger");
+        }
+        const bool negative = first[5] & 1;
+        // The top limb must be nonzero and zero must not be negative, so
+        // every value has exactly one encoding
+        const unsigned char* top = first + BIGINTEGER_HEADER_SIZE + 8 * (count - 1);
+        if ((count > 0 && load_u64(top) == 0) || (count == 0 && negative))
+        {
+            throw std::invalid_argument("Cannot read non-canonical BigInteger");
+        }
+        return Header{ negative, static_cast<std::size_t>(count) };
+    }
+
+}
+
+std::size_t serialized_size(const BigInteger& value)
+{
+    BigIntegerView view(value);
+    const bool zero = !view.is_positive() && !view.is_negative();
+    return BIGINTEGER_HEADER_SIZE + (zero ? 0 : 8 * view.size());
+}
+
+unsigned char* serialize(const BigInteger& value, unsigned char* first, unsigned char* last)
+{
+    BigIntegerView view(value);
+    const bool zero = !view.is_positive() && !view.is_negative();
+    const std::size_t count = zero ? 0 : view.size();
+    if (static_cast<std::size_t>(last - first) < BIGINTEGER_HEADER_SIZE + 8 * count)
+    {
+        return nullptr;
+    }
+    std::memcpy(first, MAGIC, 4);
+    first[4] = BIGINTEGER_FORMAT_VERSION;
+    first[5] = view.is_negative() ? 1 : 0;
+    first[6] = 0;
+    first[7] = 0;
+    store_u64(first + 8, count);
+    first += BIGINTEGER_HEADER_SIZE;
+    for (std::size_t i = 0; i < count; i++, first += 8)
+    {
+        store_u64(first, view.data()[i]);
+    }
+    return first;
+}
+
+BigInteger deserialize(const unsigned char*& first, const unsigned char* last)
+{
+    const Header header = read_header(first, last);
+    const unsigned char* limbs = first + BIGINTEGER_HEADER_SIZE;
+    BigInteger result(0);
+    if (header.count > 0)
+    {
+        LimbVector& magnitude = BigIntegerView::magnitude(result);
+        magnitude.assign(header.count, 0);
+        for (std::size_t i = 0; i < header.count; i++)
+        {
+            magnitude[i] = load_u64(limbs + 8 * i);
+        }
+        BigIntegerView::finish(result, header.negative);
+    }
+    first = limbs + 8 * header.count;
+    return result;
+}
+
+BigIntegerView::BigIntegerView(const BigInteger& value)
+    : limbs(value.number.data()), count(value.number.size()), negative(value.negative)
+{
+    if (value.number.empty())
+    {
+        throw std::invalid_argument("Cannot view uninitialized BigInteger");
+    }
+}
+
+BigIntegerView BigIntegerView::read(const unsigned char*& first, const unsigned char* last)
+{
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    throw std::invalid_argument("Cannot view serialized BigInteger on a big-endian machine");
+#endif
+    const Header header = read_header(first, last);
+    const unsigned char* limbs = first + BIGINTEGER_HEADER_SIZE;
+    if (reinterpret_cast<std::uintptr_t>(limbs) % alignof(std::uint64_t) != 0)
+    {
+        throw std::invalid_argument("Cannot view misaligned BigInteger");
+    }
+    first = limbs + 8 * header.count;
+    if (header.count == 0)
+    {
+        return BigIntegerView(&ZERO_LIMB, 1, false);
+    }
+    return BigIntegerView(reinterpret_cast<const std::uint64_t*>(limbs), header.count, header.negative);
+}
+
+LimbVector& BigIntegerView::magnitude(BigInteger& value)
+{
+    return value.number;
+}
+
+void BigIntegerView::finish(BigInteger& value, bool negative)
+{
+    value.negative = negative;
+    value.normalize();
+}
+
+BigInteger BigIntegerView::to_big_integer() const
+{
+    BigInteger result(0);
+    result.number.assign(limbs, limbs + count);
+    finish(result, negative);
+    return result;
+}
+
+std::string BigIntegerView::to_string() const
+{
+    // 20 digits cover a limb
+    std::string digits(20 * count + 1, '\0');
+    char* out = &digits[0];
+    if (negative)
+    {
+        *out++ = '-';
+    }
+    bigint_detail::write_decimal(limbs, count, out, &digits[0] + digits.size());
+    digits.resize(static_cast<std::size_t>(out - &digits[0]));
+    return digits;
+}
+
+std::ostream& operator<<(std::ostream& os, BigIntegerView value)
+{
+    return os << value.to_string();
+}
+
+int compare(BigIntegerView a, BigIntegerView b)
+{
+    if (a.negative != b.negative)
+    {
+        return a.negative ? -1 : 1;
+    }
+    const int magnitude = bigint_detail::cmp(a.limbs, a.count, b.limbs, b.count);
+    return a.negative ? -magnitude : magnitude;
+}
+
+BigInteger operator+(BigIntegerView a, BigIntegerView b)
+{
+    if (a.count < b.count)
+    {
+        std::swap(a, b);
+    }
+    BigInteger result(0);
+    LimbVector& r = BigIntegerView::magnitude(result);
+    if (a.negative == b.negative)
+    {
+        r.assign(a.count + 1, 0);
+        r[a.count] = bigint_detail::add(r.data(), a.limbs, a.count, b.limbs, b.count);
+    }
+    else
+    {
+        if (bigint_detail::cmp(a.limbs, a.count, b.limbs, b.count) < 0)
+        {
+            std::swap(a, b);
+        }
+        r.assign(a.count, 0);
+        bigint_detail::sub(r.data(), a.limbs, a.count, b.limbs, b.count);
+    }
+    BigIntegerView::finish(result, a.negative);
+    return result;
+}
+
+BigInteger operator-(BigIntegerView a, BigIntegerView b)
+{
+    b.negative = !b.negative;
+    return a + b;
+}
+
+BigInteger operator*(BigIntegerView a, BigIntegerView b)
+{
+    BigInteger result(0);
+    LimbVector& r = BigIntegerView::magnitude(result);
+    r.assign(a.count + b.count, 0);
+    bigint_detail::mul(r.data(), a.limbs, a.count, b.limbs, b.count);
+    BigIntegerView::finish(result, a.negative != b.negative);
+    return result;
+}
+
+namespace
+{
+    // Truncating division of the viewed magnitudes into quotient and
+    // remainder, which get their signs from the caller
+    void divide_views(BigIntegerView a, BigIntegerView b, LimbVector& quotient, LimbVector& remainder)
+    {
+        if (!b.is_positive() && !b.is_negative())
+        {
+            throw std::invalid_argument("Cannot divide BigInteger by zero");
+        }
+        if (bigint_detail::cmp(a.data(), a.size(), b.data(), b.size()) < 0)
+        {
+            quotient.assign(1, 0);
+            remainder.assign(a.data(), a.data() + a.size());
+            return;
+        }
+        quotient.assign(a.size() - b.size() + 1, 0);
+        remainder.assign(b.size(), 0);
+        bigint_detail::divrem(quotient.data(), remainder.data(), a.data(), a.size(), b.data(), b.size());
+    }
+}
+
+BigInteger operator/(BigIntegerView a, BigIntegerView b)
+{
+    BigInteger quotient(0);
+    LimbVector remainder;
+    divide_views(a, b, BigIntegerView::magnitude(quotient), remainder);
+    BigIntegerView::finish(quotient, a.negative != b.negative);
+    return quotient;
+}
+
+BigInteger operator%(BigIntegerView a, BigIntegerView b)
+{
+    LimbVector quotient;
+    BigInteger remainder(0);
+    divide_views(a, b, quotient, BigIntegerView::magnitude(remainder));
+    BigIntegerView::finish(remainder, a.negative);
+    return remainder;
+}
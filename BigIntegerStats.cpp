@@ -0,0 +1,162 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+
+namespace bigint_detail
+{
+#if defined(BIGINTEGER_INSTRUMENTATION)
+    namespace
+    {
+        thread_local BigIntegerStats thread_stats;
+        thread_local OperationScope* current_scope = nullptr;
+
+        std::size_t size_bucket(std::size_t limbs)
+        {
+            std::size_t bucket = limbs <= 1 ? 0 : 64 - static_cast<std::size_t>(__builtin_clzll(limbs - 1));
+            return std::min(bucket, BigIntegerOperationStats::SIZE_BUCKETS - 1);
+        }
+    }
+
+    OperationScope::OperationScope(BigIntegerOperation operation, std::size_t limbs)
+        : operation(operation), limbs(limbs), algorithm(BigIntegerAlgorithm::count),
+          start(std::chrono::steady_clock::now()), outer(current_scope)
+    {
+        current_scope = this;
+    }
+
+    OperationScope::~OperationScope()
+    {
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        current_scope = outer;
+        BigIntegerOperationStats& stats = thread_stats.operations[static_cast<std::size_t>(operation)];
+        stats.calls++;
+        stats.nanoseconds += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        stats.sizes[size_bucket(limbs)]++;
+        if (algorithm != BigIntegerAlgorithm::count)
+        {
+            stats.algorithms[static_cast<std::size_t>(algorithm)]++;
+        }
+    }
+
+    void note_algorithm(BigIntegerAlgorithm algorithm)
+    {
+        if (current_scope && current_scope->algorithm == BigIntegerAlgorithm::count)
+        {
+            current_scope->algorithm = algorithm;
+        }
+    }
+
+    void record_allocation(std::size_t bytes)
+    {
+        thread_stats.allocations++;
+        thread_stats.bytes_allocated += bytes;
+    }
+
+    void record_deallocation(std::size_t bytes)
+    {
+        thread_stats.deallocations++;
+        thread_stats.bytes_freed += bytes;
+    }
+#endif
+}
+
+const char* operation_name(BigIntegerOperation operation)
+{
+    static const char* const names[] = {
+        "add", "subtract", "multiply", "multiply_add", "divide", "to_decimal", "from_decimal", "pow_mod"
+    };
+    return names[static_cast<std::size_t>(operation)];
+}
+
+const char* algorithm_name(BigIntegerAlgorithm algorithm)
+{
+    static const char* const names[] = {
+        "native", "linear", "schoolbook", "karatsuba", "toom3", "ntt", "unbalanced",
+        "knuth", "burnikel_ziegler", "divide_and_conquer", "montgomery", "barrett"
+    };
+    return names[static_cast<std::size_t>(algorithm)];
+}
+
+static void append_field(std::string& out, const char* name, std::uint64_t value)
+{
+    out += '"';
+    out += name;
+    out += "\":";
+    out += std::to_string(value);
+}
+
+std::string BigIntegerStats::to_json() const
+{
+    std::string out = enabled ? "{\"enabled\":true,\"operations\":{" : "{\"enabled\":false,\"operations\":{";
+    bool first_operation = true;
+    for (std::size_t i = 0; i < operations.size(); i++)
+    {
+        const BigIntegerOperationStats& stats = operations[i];
+        if (stats.calls == 0)
+        {
+            continue;
+        }
+        if (!first_operation)
+        {
+            out += ',';
+        }
+        first_operation = false;
+        out += '"';
+        out += operation_name(static_cast<BigIntegerOperation>(i));
+        out += "\":{";
+        append_field(out, "calls", stats.calls);
+        out += ',';
+        append_field(out, "nanoseconds", stats.nanoseconds);
+
+        // Sizes are keyed by the bucket's upper bound in limbs
+        out += ",\"sizes\":{";
+        bool first = true;
+        for (std::size_t b = 0; b < stats.sizes.size(); b++)
+        {
+            if (stats.sizes[b] != 0)
+            {
+                out += first ? "" : ",";
+                append_field(out, std::to_string(std::uint64_t(1) << b).c_str(), stats.sizes[b]);
+                first = false;
+            }
+        }
+        out += "},\"algorithms\":{";
+        first = true;
+        for (std::size_t a = 0; a < stats.algorithms.size(); a++)
+        {
+            if (stats.algorithms[a] != 0)
+            {
+                out += first ? "" : ",";
+                append_field(out, algorithm_name(static_cast<BigIntegerAlgorithm>(a)), stats.algorithms[a]);
+                first = false;
+            }
+        }
+        out += "}}";
+    }
+    out += "},\"memory\":{";
+    append_field(out, "allocations", allocations);
+    out += ',';
+    append_field(out, "deallocations", deallocations);
+    out += ',';
+    append_field(out, "bytes_allocated", bytes_allocated);
+    out += ',';
+    append_field(out, "bytes_freed", bytes_freed);
+    out += "}}";
+    return out;
+}
+
+BigIntegerStats BigInteger::stats()
+{
+#if defined(BIGINTEGER_INSTRUMENTATION)
+    return bigint_detail::thread_stats;
+#else
+    return BigIntegerStats();
+#endif
+}
+
+void BigInteger::reset_stats()
+{
+#if defined(BIGINTEGER_INSTRUMENTATION)
+    bigint_detail::thread_stats = BigIntegerStats();
+#endif
+}
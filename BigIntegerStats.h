@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Optional instrumentation of BigInteger operations: call counts, cumulative
+// time, operand sizes, the algorithm each call ended up using and the bytes
+// BigInteger storage allocates and frees. Recording is compiled in only when
+// the whole program is built with BIGINTEGER_INSTRUMENTATION defined (make
+// INSTRUMENTATION=1); otherwise every hook is an empty inline function and
+// BigInteger::stats() returns zeros.
+//
+// Counters are thread-local, so recording never synchronizes. A snapshot
+// covers the calling thread only: subproducts handed to worker threads are
+// timed as part of the caller's operation, but their allocations count on
+// the workers.
+
+enum class BigIntegerOperation
+{
+    add,
+    subtract,
+    multiply,
+    multiply_add,
+    divide,
+    to_decimal,
+    from_decimal,
+    pow_mod,
+    count
+};
+
+// The algorithm chosen at the top level of an operation; recursive calls
+// inside it are not counted separately.
+enum class BigIntegerAlgorithm
+{
+    native,
+    linear,
+    schoolbook,
+    karatsuba,
+    toom3,
+    ntt,
+    unbalanced,
+    knuth,
+    burnikel_ziegler,
+    divide_and_conquer,
+    montgomery,
+    barrett,
+    count
+};
+
+struct BigIntegerOperationStats
+{
+    // Bucket b counts calls whose larger operand has at most 2^b limbs (and
+    // more than 2^(b-1)); the last bucket takes everything beyond.
+    static const std::size_t SIZE_BUCKETS = 32;
+
+    std::uint64_t calls = 0;
+    std::uint64_t nanoseconds = 0;
+    std::array<std::uint64_t, SIZE_BUCKETS> sizes{};
+    std::array<std::uint64_t, static_cast<std::size_t>(BigIntegerAlgorithm::count)> algorithms{};
+};
+
+struct BigIntegerStats
+{
+#if defined(BIGINTEGER_INSTRUMENTATION)
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    std::array<BigIntegerOperationStats, static_cast<std::size_t>(BigIntegerOperation::count)> operations{};
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t bytes_allocated = 0;
+    std::uint64_t bytes_freed = 0;
+
+    const BigIntegerOperationStats& operator[](BigIntegerOperation operation) const
+    {
+        return operations[static_cast<std::size_t>(operation)];
+    }
+
+    // One JSON object; operations that were never called are left out.
+    std::string to_json() const;
+};
+
+// Names used in the JSON dump
+const char* operation_name(BigIntegerOperation operation);
+const char* algorithm_name(BigIntegerAlgorithm algorithm);
+
+namespace bigint_detail
+{
+#if defined(BIGINTEGER_INSTRUMENTATION)
+    void record_allocation(std::size_t bytes);
+    void record_deallocation(std::size_t bytes);
+#else
+    inline void record_allocation(std::size_t)
+    {
+    }
+
+    inline void record_deallocation(std::size_t)
+    {
+    }
+#endif
+}
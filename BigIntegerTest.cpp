@@ -1,7 +1,80 @@
 
 
 #include "BigInteger.h"
+#include "BigIntegerArena.h"
+#include "BigIntegerExpression.h"
+#include "BigIntegerInternal.h"
+#include "BigIntegerLiteral.h"
+#include "BigIntegerModContext.h"
+#include "BigIntegerNumeric.h"
+#include "BigIntegerParser.h"
+#include "BigIntegerView.h"
+#include "FixedBigInteger.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+// Counts heap allocations so tests can check which operations stay inline.
+static std::atomic<std::size_t> allocation_count(0);
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+    if (void* block = std::malloc(size ? size : 1))
+    {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+// std::pmr::new_delete_resource goes through the aligned forms
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    allocation_count++;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* block = std::aligned_alloc(align, (size + align - 1) / align * align + (size ? 0 : align)))
+    {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept
+{
+    std::free(block);
+}
+
+static std::string random_digits(std::mt19937_64& rng, std::size_t length)
+{
+    std::string digits(length, '0');
+    for (char& digit : digits)
+    {
+        digit = static_cast<char>('0' + rng() % 10);
+    }
+    digits[0] = static_cast<char>('1' + rng() % 9);
+    return digits;
+}
 
 TEST(BigIntegerTest, DefaultConstructor) 
 {
@@ -188,9 +261,9 @@ TEST(BigIntegerTest, LessThanOperator)
     BigInteger negB("-67890");
     BigInteger negC("-12345");
 
-    EXPECT_TRUE(negA < negB);
+    EXPECT_FALSE(negA < negB);
     EXPECT_FALSE(negA < negC);
-    EXPECT_FALSE(negB < negA);
+    EXPECT_TRUE(negB < negA);
     EXPECT_FALSE(negC < negA);
     EXPECT_FALSE(negA < negA);
 
@@ -220,9 +293,9 @@ TEST(BigIntegerTest, LessThanEqualOperator)
     BigInteger negB("-67890");
     BigInteger negC("-12345");
 
-    EXPECT_TRUE(negA <= negB);
+    EXPECT_FALSE(negA <= negB);
     EXPECT_TRUE(negA <= negC);
-    EXPECT_FALSE(negB <= negA);
+    EXPECT_TRUE(negB <= negA);
     EXPECT_TRUE(negC <= negA);
     EXPECT_TRUE(negA <= negA);
 
@@ -252,9 +325,9 @@ TEST(BigIntegerTest, GreaterThanOperator)
     BigInteger negB("-67890");
     BigInteger negC("-12345");
 
-    EXPECT_FALSE(negA > negB);
+    EXPECT_TRUE(negA > negB);
     EXPECT_FALSE(negA > negC);
-    EXPECT_TRUE(negB > negA);
+    EXPECT_FALSE(negB > negA);
     EXPECT_FALSE(negC > negA);
     EXPECT_FALSE(negA > negA);
 
@@ -284,9 +357,9 @@ TEST(BigIntegerTest, GreaterThanEqualOperator)
     BigInteger negB("-67890");
     BigInteger negC("-12345");
 
-    EXPECT_FALSE(negA >= negB);
+    EXPECT_TRUE(negA >= negB);
     EXPECT_TRUE(negA >= negC);
-    EXPECT_TRUE(negB >= negA);
+    EXPECT_FALSE(negB >= negA);
     EXPECT_TRUE(negC >= negA);
     EXPECT_TRUE(negA >= negA);
 
@@ -367,6 +440,1548 @@ TEST(BigIntegerTest, Multiply)
     EXPECT_TRUE(a*d == d*a);
 }
 
+TEST(BigIntegerTest, MultiLimbArithmetic)
+{
+    BigInteger a("123456789012345678901234567890123456789012345678901234567890");
+    BigInteger b("987654321098765432109876543210987654321");
+    EXPECT_EQ(a.to_string(), "123456789012345678901234567890123456789012345678901234567890");
+    EXPECT_EQ((a + b).to_string(), "123456789012345678902222222211222222221122222222112222222211");
+    EXPECT_EQ((a - b).to_string(), "123456789012345678900246913569024691356902469135690246913569");
+    EXPECT_EQ((b - a).to_string(), "-123456789012345678900246913569024691356902469135690246913569");
+    EXPECT_EQ((a * b).to_string(), "121932631137021795226185032733866788594499314128449931412844871208653362292333223746380111126352690");
+    EXPECT_EQ((-a * b).to_string(), "-121932631137021795226185032733866788594499314128449931412844871208653362292333223746380111126352690");
+
+    BigInteger limb(18446744073709551615ULL);
+    BigInteger one(1);
+    EXPECT_EQ((limb + one).to_string(), "18446744073709551616");
+    EXPECT_EQ(((limb + one) * (limb + one)).to_string(), "340282366920938463463374607431768211456");
+    EXPECT_EQ(((limb + one) - one).to_string(), "18446744073709551615");
+
+    EXPECT_EQ(BigInteger("000123").to_string(), "123");
+    EXPECT_EQ(BigInteger("-0").to_string(), "0");
+    EXPECT_EQ(BigInteger(-9223372036854775807LL - 1).to_string(), "-9223372036854775808");
+}
+
+TEST(BigIntegerTest, MultiplyAlgorithmsAgree)
+{
+    std::mt19937_64 rng(2024);
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    const std::size_t sizes[][2] = { {700, 700}, {2000, 1900}, {5000, 300}, {3000, 1200}, {4500, 4500} };
+    for (const auto& size : sizes)
+    {
+        BigInteger a(random_digits(rng, size[0]));
+        BigInteger b("-" + random_digits(rng, size[1]));
+
+        BigInteger::thresholds().karatsuba = 1000000;
+        BigInteger::thresholds().toom3 = 1000000;
+        BigInteger schoolbook = a * b;
+
+        BigInteger::thresholds().karatsuba = 4;
+        BigInteger::thresholds().toom3 = 1000000;
+        BigInteger karatsuba = a * b;
+
+        BigInteger::thresholds().karatsuba = 4;
+        BigInteger::thresholds().toom3 = 12;
+        BigInteger toom3 = a * b;
+
+        BigInteger::thresholds() = saved;
+        EXPECT_EQ(karatsuba, schoolbook);
+        EXPECT_EQ(toom3, schoolbook);
+        EXPECT_EQ(b * a, schoolbook);
+        EXPECT_TRUE(schoolbook.is_negative());
+    }
+}
+
+TEST(BigIntegerTest, NttMultiplyMatchesToom3)
+{
+    std::mt19937_64 rng(7);
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    const std::size_t sizes[][2] = { {3000, 3000}, {6000, 2500}, {4000, 900}, {10, 8000} };
+    for (const auto& size : sizes)
+    {
+        BigInteger a(random_digits(rng, size[0]));
+        BigInteger b("-" + random_digits(rng, size[1]));
+
+        BigInteger::thresholds().ntt = 1000000;
+        BigInteger expected = a * b;
+        BigInteger expected_square = a * BigInteger(a);
+
+        BigInteger::thresholds().ntt = 16;
+        BigInteger product = a * b;
+        BigInteger square = a * a;
+
+        BigInteger::thresholds() = saved;
+        EXPECT_EQ(product, expected);
+        EXPECT_EQ(square, expected_square);
+    }
+
+    // All-ones limbs give the largest possible convolution coefficients
+    BigInteger ones = BigInteger(18446744073709551615ULL);
+    BigInteger limb_base = ones + BigInteger(1);
+    BigInteger big = ones;
+    for (int i = 0; i < 200; i++)
+    {
+        big = big * limb_base + ones;
+    }
+    BigInteger::thresholds().ntt = 1000000;
+    BigInteger expected = big * BigInteger(big);
+    BigInteger::thresholds().ntt = 16;
+    BigInteger square = big * big;
+    BigInteger::thresholds() = saved;
+    EXPECT_EQ(square, expected);
+}
+
+TEST(BigIntegerTest, Division)
+{
+    BigInteger a("121932631137021795226185032733866788594499314128449931412844871208653362292333223746380111126365035");
+    BigInteger b("987654321098765432109876543210987654321");
+    EXPECT_EQ((a / b).to_string(), "123456789012345678901234567890123456789012345678901234567890");
+    EXPECT_EQ((a % b).to_string(), "12345");
+
+    // Truncated semantics matching the built-in operators
+    EXPECT_EQ((BigInteger(7) / BigInteger(2)).to_string(), "3");
+    EXPECT_EQ((BigInteger(-7) / BigInteger(2)).to_string(), "-3");
+    EXPECT_EQ((BigInteger(-7) % BigInteger(2)).to_string(), "-1");
+    EXPECT_EQ((BigInteger(7) / BigInteger(-2)).to_string(), "-3");
+    EXPECT_EQ((BigInteger(7) % BigInteger(-2)).to_string(), "1");
+    EXPECT_EQ((BigInteger(-7) / BigInteger(-2)).to_string(), "3");
+    EXPECT_EQ((BigInteger(-7) % BigInteger(-2)).to_string(), "-1");
+    EXPECT_EQ((BigInteger(-6) % BigInteger(3)).to_string(), "0");
+    EXPECT_FALSE((BigInteger(-6) % BigInteger(3)).is_negative());
+    EXPECT_EQ((BigInteger(5) / BigInteger(-9)).to_string(), "0");
+    EXPECT_FALSE((BigInteger(5) / BigInteger(-9)).is_negative());
+    // A dividend that fits in 128 bits over a longer divisor
+    EXPECT_EQ((BigInteger(5) % BigInteger("340282366920938463463374607431768211456")).to_string(), "5");
+
+    std::pair<BigInteger, BigInteger> qr = divmod(-a, b);
+    EXPECT_EQ(qr.first.to_string(), "-123456789012345678901234567890123456789012345678901234567890");
+    EXPECT_EQ(qr.second.to_string(), "-12345");
+
+    BigInteger c("1000000000000000000000");
+    c /= BigInteger(1000);
+    EXPECT_EQ(c.to_string(), "1000000000000000000");
+    c %= BigInteger(999);
+    EXPECT_EQ(c.to_string(), "1");
+
+    BigInteger uninit;
+    EXPECT_THROW(a / BigInteger(0), std::invalid_argument);
+    EXPECT_THROW(a % BigInteger(0), std::invalid_argument);
+    EXPECT_THROW(a / uninit, std::invalid_argument);
+    EXPECT_THROW(uninit % a, std::invalid_argument);
+}
+
+TEST(BigIntegerTest, DivisionAlgorithmsAgree)
+{
+    std::mt19937_64 rng(99);
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    const std::size_t sizes[][2] = { {4000, 2000}, {6000, 1500}, {3000, 2990}, {5000, 60}, {2500, 2500} };
+    for (const auto& size : sizes)
+    {
+        BigInteger a(random_digits(rng, size[0]));
+        BigInteger b("-" + random_digits(rng, size[1]));
+
+        BigInteger::thresholds().burnikel_ziegler = 1000000;
+        std::pair<BigInteger, BigInteger> knuth = divmod(a, b);
+        BigInteger::thresholds().burnikel_ziegler = 4;
+        std::pair<BigInteger, BigInteger> recursive = divmod(a, b);
+        BigInteger::thresholds() = saved;
+
+        EXPECT_EQ(recursive.first, knuth.first);
+        EXPECT_EQ(recursive.second, knuth.second);
+        EXPECT_EQ(knuth.first * b + knuth.second, a);
+        EXPECT_FALSE(knuth.second.is_negative());
+        EXPECT_TRUE(knuth.second < -b);
+    }
+}
+
+TEST(BigIntegerTest, DecimalConversion)
+{
+    std::mt19937_64 rng(11);
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    for (std::size_t length : { 1, 19, 20, 380, 1000, 4000, 9000 })
+    {
+        std::string digits = random_digits(rng, length);
+        std::string padded = digits;
+        padded.replace(length / 2, std::min<std::size_t>(length / 3, 50), std::min<std::size_t>(length / 3, 50), '0');
+
+        BigInteger::thresholds().conversion = 2;
+        BigInteger recursive(digits);
+        BigInteger recursive_padded("-" + padded);
+        EXPECT_EQ(recursive.to_string(), digits);
+        EXPECT_EQ(recursive_padded.to_string(), "-" + padded);
+
+        BigInteger::thresholds().conversion = 1000000;
+        EXPECT_EQ(BigInteger(digits), recursive);
+        EXPECT_EQ(BigInteger("-" + padded), recursive_padded);
+        BigInteger::thresholds() = saved;
+    }
+}
+
+TEST(BigIntegerTest, CharsConversion)
+{
+    BigInteger value("-98765432109876543210987654321");
+    char buffer[64];
+    ASSERT_GE(sizeof(buffer), value.max_decimal_length());
+    std::to_chars_result written = to_chars(buffer, buffer + sizeof(buffer), value);
+    EXPECT_EQ(written.ec, std::errc());
+    EXPECT_EQ(std::string(buffer, written.ptr), "-98765432109876543210987654321");
+
+    std::to_chars_result too_small = to_chars(buffer, buffer + 10, value);
+    EXPECT_EQ(too_small.ec, std::errc::value_too_large);
+    EXPECT_EQ(too_small.ptr, buffer + 10);
+
+    const char text[] = "-123456789012345678901234567890xyz";
+    BigInteger parsed;
+    std::from_chars_result read = from_chars(text, text + sizeof(text) - 1, parsed);
+    EXPECT_EQ(read.ec, std::errc());
+    EXPECT_EQ(read.ptr, text + 31);
+    EXPECT_EQ(parsed.to_string(), "-123456789012345678901234567890");
+
+    const char invalid[] = "-x12";
+    std::from_chars_result failed = from_chars(invalid, invalid + 4, parsed);
+    EXPECT_EQ(failed.ec, std::errc::invalid_argument);
+    EXPECT_EQ(failed.ptr, invalid);
+    EXPECT_EQ(parsed.to_string(), "-123456789012345678901234567890");
+
+    BigInteger zero(0);
+    written = to_chars(buffer, buffer + 1, zero);
+    EXPECT_EQ(written.ec, std::errc());
+    EXPECT_EQ(std::string(buffer, written.ptr), "0");
+}
+
+TEST(BigIntegerTest, SmallValuesStayInline)
+{
+    BigInteger a(1234567890123456789LL);
+    BigInteger b(-987654321);
+    BigInteger c("340282366920938463463374607431768211455");
+    char buffer[64];
+
+    std::size_t before = allocation_count;
+    BigInteger sum = a + b;
+    BigInteger difference = b - a;
+    BigInteger product = a * b;
+    BigInteger quotient = c / a;
+    BigInteger remainder = c % b;
+    BigInteger copy(c);
+    copy = product;
+    bool ordered = b < a && a != b;
+    std::to_chars_result written = to_chars(buffer, buffer + sizeof(buffer), c);
+    BigInteger parsed;
+    from_chars(buffer, written.ptr, parsed);
+    EXPECT_EQ(allocation_count, before);
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(sum.to_string(), "1234567889135802468");
+    EXPECT_EQ(difference.to_string(), "-1234567891111111110");
+    EXPECT_EQ(product.to_string(), "-1219326311248285321112635269");
+    EXPECT_EQ(quotient.to_string(), "275628719686618632835");
+    EXPECT_EQ(remainder.to_string(), "282069525");
+    EXPECT_EQ(parsed, c);
+
+    // Overflowing 128 bits moves the value to the heap
+    before = allocation_count;
+    BigInteger spilled = c + BigInteger(1);
+    EXPECT_GT(allocation_count, before);
+    EXPECT_EQ(spilled.to_string(), "340282366920938463463374607431768211456");
+    EXPECT_EQ((spilled - BigInteger(1)), c);
+}
+
+TEST(BigIntegerTest, CompoundAssignment)
+{
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 200; i++)
+    {
+        BigInteger a((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 120));
+        BigInteger b((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 120));
+        BigInteger expected_sum = a + b;
+        BigInteger expected_difference = a - b;
+        BigInteger expected_product = a * b;
+
+        BigInteger c = a;
+        c += b;
+        EXPECT_EQ(c, expected_sum);
+        c = a;
+        c -= b;
+        EXPECT_EQ(c, expected_difference);
+        c = a;
+        c *= b;
+        EXPECT_EQ(c, expected_product);
+        c /= b;
+        EXPECT_EQ(c, a);
+        c = a;
+        c %= b;
+        EXPECT_EQ(c, a % b);
+
+        EXPECT_EQ(BigInteger(a) + b, expected_sum);
+        EXPECT_EQ(a + BigInteger(b), expected_sum);
+        EXPECT_EQ(BigInteger(a) - b, expected_difference);
+        EXPECT_EQ(a - BigInteger(b), expected_difference);
+        EXPECT_EQ(BigInteger(a) - BigInteger(b), expected_difference);
+        EXPECT_EQ(a * BigInteger(b), expected_product);
+        EXPECT_EQ(-BigInteger(a), -a);
+    }
+
+    BigInteger self("-123456789012345678901234567890");
+    self += self;
+    EXPECT_EQ(self.to_string(), "-246913578024691357802469135780");
+    self -= self;
+    EXPECT_EQ(self.to_string(), "0");
+    EXPECT_THROW(self += BigInteger(), std::invalid_argument);
+    EXPECT_THROW(self *= BigInteger(), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, SteadyStateAccumulationDoesNotAllocate)
+{
+    BigInteger x("123456789012345678901234567890123456789012345678901234567890");
+    BigInteger sum(0);
+    for (int i = 0; i < 16; i++)
+    {
+        sum += x;
+    }
+    std::size_t before = allocation_count;
+    for (int i = 0; i < 1000; i++)
+    {
+        sum += x;
+        sum -= 1;
+    }
+    EXPECT_EQ(allocation_count, before);
+    EXPECT_EQ(sum, x * BigInteger(1016) - BigInteger(1000));
+
+    BigInteger y("987654321098765432109876543210987654321098765432109876543210");
+    BigInteger product;
+    for (int i = 0; i < 2; i++)
+    {
+        product = x;
+        product *= y;
+    }
+    before = allocation_count;
+    for (int i = 0; i < 100; i++)
+    {
+        product = x;
+        product *= y;
+    }
+    EXPECT_EQ(allocation_count, before);
+    EXPECT_EQ(product, x * y);
+
+    // Moving hands the buffer over instead of copying it
+    before = allocation_count;
+    BigInteger moved(std::move(product));
+    BigInteger assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(allocation_count, before);
+    EXPECT_EQ(assigned, x * y);
+}
+
+TEST(BigIntegerTest, FusedMultiplyAdd)
+{
+    std::mt19937_64 rng(8);
+    for (int i = 0; i < 300; i++)
+    {
+        BigInteger a((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 400));
+        BigInteger b((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 400));
+        BigInteger c((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 900));
+        BigInteger sum = c;
+        sum.addmul(a, b);
+        EXPECT_EQ(sum, c + a * b);
+        BigInteger difference = c;
+        difference.submul(a, b);
+        EXPECT_EQ(difference, c - a * b);
+    }
+
+    BigInteger x("-99999999999999999999999999999999999999999");
+    BigInteger y = x;
+    y.submul(x, BigInteger(1));
+    EXPECT_EQ(y.to_string(), "0");
+    BigInteger expected = x + x * x;
+    x.addmul(x, x);
+    EXPECT_EQ(x, expected);
+}
+
+TEST(BigIntegerTest, ExpressionTemplates)
+{
+    std::mt19937_64 rng(9);
+    for (int i = 0; i < 200; i++)
+    {
+        BigInteger a((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 100));
+        BigInteger b((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 100));
+        BigInteger c((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 200));
+        BigInteger d((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 200));
+
+        BigInteger r = lazy(a) * b + c - d;
+        EXPECT_EQ(r, a * b + c - d);
+        r = c - lazy(a) * b;
+        EXPECT_EQ(r, c - a * b);
+        r = lazy(a) * b - c;
+        EXPECT_EQ(r, a * b - c);
+        r = (lazy(a) + b) * (lazy(c) - d) + lazy(a) * d;
+        EXPECT_EQ(r, (a + b) * (c - d) + a * d);
+        r = lazy(a) + 5;
+        EXPECT_EQ(r, a + 5);
+
+        // The destination may appear on the right-hand side
+        BigInteger expected = b * a + a;
+        r = a;
+        r = lazy(b) * r + r;
+        EXPECT_EQ(r, expected);
+        expected = r + c * d;
+        r += lazy(c) * d;
+        EXPECT_EQ(r, expected);
+        expected = r - r * d;
+        r -= lazy(r) * d;
+        EXPECT_EQ(r, expected);
+    }
+
+    // Reassigning an expression of the same size reuses the destination
+    BigInteger a("123456789012345678901234567890123456789012345678901234567890");
+    BigInteger b("-98765432109876543210987654321");
+    BigInteger c("55555555555555555555555555555555555555555555555555555555555555555555555");
+    BigInteger r = lazy(a) * b + c;
+    std::size_t before = allocation_count;
+    for (int i = 0; i < 100; i++)
+    {
+        r = lazy(a) * b + c;
+    }
+    EXPECT_EQ(allocation_count, before);
+    EXPECT_EQ(r, a * b + c);
+}
+
+TEST(BigIntegerTest, ArenaStorage)
+{
+    std::mt19937_64 rng(10);
+    BigInteger x(random_digits(rng, 500));
+    BigInteger y("-" + random_digits(rng, 300));
+
+    BigIntegerArena arena;
+    BigInteger total(&arena);
+    total = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        total += x;
+        total *= y;
+        total %= x;
+    }
+    EXPECT_EQ(total.get_memory_resource(), &arena);
+    EXPECT_GT(arena.bytes_used(), 0u);
+
+    BigInteger expected(0);
+    for (int i = 0; i < 50; i++)
+    {
+        expected = (expected + x) * y % x;
+    }
+    EXPECT_EQ(total, expected);
+
+    // Copies leave the arena; assignment keeps the target on it
+    BigInteger copy(total);
+    EXPECT_EQ(copy.get_memory_resource(), std::pmr::get_default_resource());
+    BigInteger on_arena(copy, &arena);
+    EXPECT_EQ(on_arena.get_memory_resource(), &arena);
+    on_arena = x * y;
+    EXPECT_EQ(on_arena.get_memory_resource(), &arena);
+    EXPECT_EQ(on_arena, x * y);
+    BigInteger moved(std::move(on_arena));
+    EXPECT_EQ(moved.get_memory_resource(), &arena);
+
+    arena.release();
+    EXPECT_EQ(arena.bytes_used(), 0u);
+}
+
+TEST(BigIntegerTest, ScratchWorkspaceIsReused)
+{
+    std::mt19937_64 rng(11);
+    BigInteger x(random_digits(rng, 2000));
+    BigInteger y(random_digits(rng, 1900));
+    BigInteger product;
+    std::string digits(x.max_decimal_length(), '\0');
+    for (int i = 0; i < 2; i++)
+    {
+        product = x;
+        product *= y;
+        to_chars(&digits[0], &digits[0] + digits.size(), x);
+    }
+
+    // Karatsuba and the recursive decimal conversion draw all their
+    // temporaries from the per-thread pool
+    std::size_t before = allocation_count;
+    for (int i = 0; i < 10; i++)
+    {
+        product = x;
+        product *= y;
+        to_chars(&digits[0], &digits[0] + digits.size(), x);
+    }
+    EXPECT_EQ(allocation_count, before);
+    EXPECT_EQ(product, x * y);
+    EXPECT_EQ(digits, x.to_string());
+}
+
+TEST(BigIntegerTest, KernelPathsAgree)
+{
+    using namespace bigint_detail;
+    const KernelPath original = kernel_path();
+    const KernelPath paths[] = { KernelPath::scalar, KernelPath::avx2, KernelPath::avx512 };
+    std::mt19937_64 rng(12);
+
+    // Limbs biased toward 0 and ~0 so carries and borrows run through long
+    // stretches of propagating lanes.
+    auto fill = [&rng](std::vector<limb_t>& limbs)
+    {
+        for (limb_t& limb : limbs)
+        {
+            switch (rng() % 4)
+            {
+                case 0: limb = 0; break;
+                case 1: limb = ~static_cast<limb_t>(0); break;
+                default: limb = rng(); break;
+            }
+        }
+    };
+
+    for (int round = 0; round < 400; round++)
+    {
+        std::size_t n = rng() % 70;
+        std::vector<limb_t> a(n), b(n), r(n + 1);
+        fill(a);
+        fill(b);
+        limb_t factor = rng() % 3 == 0 ? ~static_cast<limb_t>(0) : rng();
+
+        set_kernel_path(KernelPath::scalar);
+        std::vector<limb_t> sum(n), difference(n), accumulated(r);
+        limb_t carry = add_n(sum.data(), a.data(), b.data(), n);
+        limb_t borrow = sub_n(difference.data(), a.data(), b.data(), n);
+        limb_t high = addmul_1(accumulated.data(), a.data(), n, factor);
+        std::vector<limb_t> conjunction(n), disjunction(n), exclusive(n), complement(n);
+        and_n(conjunction.data(), a.data(), b.data(), n);
+        ior_n(disjunction.data(), a.data(), b.data(), n);
+        xor_n(exclusive.data(), a.data(), b.data(), n);
+        com_n(complement.data(), a.data(), n);
+        std::size_t bits = popcount_n(a.data(), n);
+
+        for (KernelPath path : paths)
+        {
+            if (!set_kernel_path(path))
+            {
+                continue;
+            }
+            std::vector<limb_t> out(n);
+            EXPECT_EQ(add_n(out.data(), a.data(), b.data(), n), carry);
+            EXPECT_EQ(out, sum);
+            EXPECT_EQ(sub_n(out.data(), a.data(), b.data(), n), borrow);
+            EXPECT_EQ(out, difference);
+
+            // In place, as the compound operators use them
+            out = a;
+            EXPECT_EQ(add_n(out.data(), out.data(), b.data(), n), carry);
+            EXPECT_EQ(out, sum);
+            out = b;
+            EXPECT_EQ(sub_n(out.data(), a.data(), out.data(), n), borrow);
+            EXPECT_EQ(out, difference);
+
+            out = r;
+            EXPECT_EQ(addmul_1(out.data(), a.data(), n, factor), high);
+            EXPECT_EQ(out, accumulated);
+
+            out = a;
+            and_n(out.data(), out.data(), b.data(), n);
+            EXPECT_EQ(out, conjunction);
+            out = a;
+            ior_n(out.data(), out.data(), b.data(), n);
+            EXPECT_EQ(out, disjunction);
+            out = a;
+            xor_n(out.data(), out.data(), b.data(), n);
+            EXPECT_EQ(out, exclusive);
+            out = a;
+            com_n(out.data(), out.data(), n);
+            EXPECT_EQ(out, complement);
+            EXPECT_EQ(popcount_n(a.data(), n), bits);
+        }
+    }
+
+    BigInteger x("-" + random_digits(rng, 3000));
+    BigInteger y(random_digits(rng, 2500));
+    set_kernel_path(KernelPath::scalar);
+    BigInteger product = x * y;
+    BigInteger sum = x + y;
+    for (KernelPath path : paths)
+    {
+        if (set_kernel_path(path))
+        {
+            EXPECT_EQ(x * y, product);
+            EXPECT_EQ(x + y, sum);
+            EXPECT_EQ(product / y, x);
+        }
+    }
+    set_kernel_path(original);
+}
+
+TEST(BigIntegerTest, ParallelResultsMatchSingleThreaded)
+{
+    std::mt19937_64 rng(13);
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    const std::size_t saved_threads = BigInteger::thread_count();
+
+    // Low thresholds push modest operands through every parallel path
+    BigInteger::thresholds().karatsuba = 8;
+    BigInteger::thresholds().toom3 = 48;
+    BigInteger::thresholds().burnikel_ziegler = 16;
+    BigInteger::thresholds().parallel = 8;
+    const std::size_t sizes[][2] = { {2000, 2000}, {6000, 1500}, {9000, 9000} };
+    for (std::size_t ntt : { std::size_t(1000000), std::size_t(128) })
+    {
+        BigInteger::thresholds().ntt = ntt;
+        for (const auto& size : sizes)
+        {
+            BigInteger a(random_digits(rng, size[0]));
+            BigInteger b("-" + random_digits(rng, size[1]));
+
+            BigInteger::set_thread_count(1);
+            BigInteger product = a * b;
+            BigInteger square = a * a;
+            std::pair<BigInteger, BigInteger> division = divmod(product + a, a);
+            std::string digits = product.to_string();
+
+            for (std::size_t threads : { 2, 3, 8 })
+            {
+                BigInteger::set_thread_count(threads);
+                EXPECT_EQ(BigInteger::thread_count(), threads);
+                EXPECT_EQ(a * b, product);
+                EXPECT_EQ(a * a, square);
+                std::pair<BigInteger, BigInteger> parallel_division = divmod(product + a, a);
+                EXPECT_EQ(parallel_division.first, division.first);
+                EXPECT_EQ(parallel_division.second, division.second);
+                EXPECT_EQ(product.to_string(), digits);
+            }
+        }
+    }
+
+    BigInteger::set_thread_count(0);
+    EXPECT_EQ(BigInteger::thread_count(), 1u);
+    BigInteger::set_thread_count(saved_threads);
+    BigInteger::thresholds() = saved;
+}
+
+TEST(BigIntegerTest, OperationStatistics)
+{
+    BigInteger::reset_stats();
+    BigInteger a(std::string(2000, '7'));
+    BigInteger b(std::string(1500, '3'));
+    BigInteger product = a * b;
+    BigInteger sum = a + b;
+    BigInteger quotient = product / b;
+    EXPECT_EQ(quotient, a);
+    std::string digits = sum.to_string();
+
+    BigIntegerStats stats = BigInteger::stats();
+    std::string json = stats.to_json();
+    if (!BigIntegerStats::enabled)
+    {
+        EXPECT_EQ(stats[BigIntegerOperation::multiply].calls, 0u);
+        EXPECT_EQ(stats.bytes_allocated, 0u);
+        EXPECT_NE(json.find("\"enabled\":false"), std::string::npos);
+        return;
+    }
+    const BigIntegerOperationStats& multiply = stats[BigIntegerOperation::multiply];
+    EXPECT_EQ(multiply.calls, 1u);
+    EXPECT_EQ(multiply.algorithms[static_cast<std::size_t>(BigIntegerAlgorithm::karatsuba)], 1u);
+    // 2000 digits is 104 limbs, in the bucket up to 128
+    EXPECT_EQ(multiply.sizes[7], 1u);
+    EXPECT_EQ(stats[BigIntegerOperation::add].calls, 1u);
+    EXPECT_EQ(stats[BigIntegerOperation::divide].algorithms[static_cast<std::size_t>(BigIntegerAlgorithm::burnikel_ziegler)], 1u);
+    EXPECT_EQ(stats[BigIntegerOperation::from_decimal].calls, 2u);
+    EXPECT_EQ(stats[BigIntegerOperation::to_decimal].calls, 1u);
+    EXPECT_GT(stats.bytes_allocated, 0u);
+    EXPECT_GE(stats.bytes_allocated, stats.bytes_freed);
+    EXPECT_NE(json.find("\"multiply\":{\"calls\":1,"), std::string::npos);
+    EXPECT_NE(json.find("\"karatsuba\":1"), std::string::npos);
+
+    BigInteger::reset_stats();
+    EXPECT_EQ(BigInteger::stats()[BigIntegerOperation::multiply].calls, 0u);
+}
+
+// Square-and-multiply on the plain operators, reducing after every step
+static BigInteger reference_pow_mod(BigInteger base, BigInteger exponent, const BigInteger& modulus)
+{
+    BigInteger m = modulus.is_negative() ? -modulus : modulus;
+    BigInteger result = BigInteger(1) % m;
+    base = base % m;
+    if (base.is_negative())
+    {
+        base += m;
+    }
+    BigInteger two(2);
+    while (exponent.is_positive())
+    {
+        std::pair<BigInteger, BigInteger> halves = divmod(exponent, two);
+        if (halves.second.is_positive())
+        {
+            result = result * base % m;
+        }
+        base = base * base % m;
+        exponent = halves.first;
+    }
+    return result;
+}
+
+TEST(BigIntegerTest, PowMod)
+{
+    EXPECT_EQ(pow_mod(BigInteger(4), BigInteger(13), BigInteger(497)), BigInteger(445));
+    EXPECT_EQ(pow_mod(BigInteger(-4), BigInteger(3), BigInteger(10)), BigInteger(6));
+    EXPECT_EQ(pow_mod(BigInteger(7), BigInteger(0), BigInteger(13)), BigInteger(1));
+    EXPECT_EQ(pow_mod(BigInteger(7), BigInteger(0), BigInteger(1)), BigInteger(0));
+    EXPECT_EQ(pow_mod(BigInteger(3), BigInteger(5), BigInteger(-7)), BigInteger(5));
+    EXPECT_EQ(pow_mod(BigInteger(0), BigInteger(5), BigInteger(12)), BigInteger(0));
+
+    std::mt19937_64 rng(7);
+    auto random_value = [&rng](std::size_t digits)
+    {
+        std::string text(digits, '0');
+        for (char& digit : text)
+        {
+            digit = static_cast<char>('0' + rng() % 10);
+        }
+        text[0] = '1';
+        return BigInteger(text);
+    };
+    // Odd and even moduli from one limb up, and a power of 2^64 that gives
+    // Barrett its longest reciprocal. The second pass lowers the thresholds
+    // where Montgomery and Barrett reduction switch to full products.
+    std::vector<BigInteger> moduli;
+    for (std::size_t digits : { 5, 19, 40, 150, 700 })
+    {
+        BigInteger m = random_value(digits);
+        moduli.push_back(m);
+        moduli.push_back(m + BigInteger(1));
+    }
+    moduli.push_back(BigInteger("340282366920938463463374607431768211456"));
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    for (std::size_t threshold : { std::size_t(0), std::size_t(4) })
+    {
+        BigInteger::thresholds().toom3 = threshold ? 16 : saved.toom3;
+        BigInteger::thresholds().burnikel_ziegler = threshold ? threshold : saved.burnikel_ziegler;
+        for (const BigInteger& m : moduli)
+        {
+            BigInteger base = random_value(200);
+            BigInteger exponent = random_value(60);
+            BigInteger expected = reference_pow_mod(base, exponent, m);
+            EXPECT_EQ(pow_mod(base, exponent, m), expected);
+            EXPECT_EQ(pow_mod(-base, exponent, m), reference_pow_mod(-base, exponent, m));
+            if ((m % BigInteger(2)).is_positive())
+            {
+                EXPECT_EQ(pow_mod_secure(base, exponent, m), expected);
+            }
+        }
+    }
+    BigInteger::thresholds() = saved;
+
+    EXPECT_THROW(pow_mod(BigInteger(2), BigInteger(-1), BigInteger(5)), std::invalid_argument);
+    EXPECT_THROW(pow_mod(BigInteger(2), BigInteger(3), BigInteger(0)), std::invalid_argument);
+    EXPECT_THROW(pow_mod_secure(BigInteger(2), BigInteger(3), BigInteger(10)), std::invalid_argument);
+}
+
+// Least non-negative residue through the plain operators
+static BigInteger reference_mod(const BigInteger& value, const BigInteger& modulus)
+{
+    BigInteger r = value % modulus;
+    return r.is_negative() ? r + (modulus.is_negative() ? -modulus : modulus) : r;
+}
+
+TEST(BigIntegerTest, ModContext)
+{
+    std::mt19937_64 rng(11);
+    auto random_value = [&rng](std::size_t digits)
+    {
+        std::string text(digits, '0');
+        for (char& digit : text)
+        {
+            digit = static_cast<char>('0' + rng() % 10);
+        }
+        text[0] = '1';
+        return BigInteger(text);
+    };
+    // Small moduli reduce by division, larger ones by Barrett products
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    BigInteger::thresholds().burnikel_ziegler = 4;
+    for (std::size_t digits : { 3, 20, 45, 300 })
+    {
+        for (int parity = 0; parity < 2; parity++)
+        {
+            BigInteger m = random_value(digits) + BigInteger(parity);
+            ModContext ring(-m);
+            EXPECT_EQ(ring.modulus(), m);
+
+            BigInteger a = random_value(digits + 5);
+            BigInteger b = -random_value(digits / 2 + 1);
+            BigInteger huge = random_value(7 * digits + 40);
+            EXPECT_EQ(ring.reduce(a), reference_mod(a, m));
+            EXPECT_EQ(ring.reduce(b), reference_mod(b, m));
+            EXPECT_EQ(ring.reduce(huge), reference_mod(huge, m));
+            EXPECT_EQ(ring.reduce(-huge), reference_mod(-huge, m));
+            EXPECT_EQ(ring.addmod(a, b), reference_mod(a + b, m));
+            EXPECT_EQ(ring.submod(b, a), reference_mod(b - a, m));
+            EXPECT_EQ(ring.mulmod(a, b), reference_mod(a * b, m));
+            EXPECT_EQ(ring.mulmod(huge, huge), reference_mod(huge * huge, m));
+            EXPECT_EQ(ring.pow(b, a), pow_mod(b, a, m));
+
+            std::vector<BigInteger> batch = { a, b, huge, -huge, BigInteger(0), m };
+            std::vector<BigInteger> expected;
+            for (const BigInteger& value : batch)
+            {
+                expected.push_back(reference_mod(value, m));
+            }
+            ring.reduce(batch.data(), batch.size());
+            EXPECT_EQ(batch, expected);
+        }
+    }
+    BigInteger::thresholds() = saved;
+
+    // 2^127 - 1 is prime, so every nonzero residue has an inverse
+    ModContext prime(BigInteger("170141183460469231731687303715884105727"));
+    BigInteger value = -random_value(60);
+    EXPECT_EQ(prime.mulmod(prime.inverse(value), value), BigInteger(1));
+    ModContext even(BigInteger(12));
+    EXPECT_EQ(even.inverse(BigInteger(-7)), BigInteger(5));
+    EXPECT_THROW(even.inverse(BigInteger(9)), std::invalid_argument);
+    ModContext trivial(BigInteger(1));
+    EXPECT_EQ(trivial.mulmod(BigInteger(5), BigInteger(7)), BigInteger(0));
+    EXPECT_EQ(trivial.pow(BigInteger(5), BigInteger(0)), BigInteger(0));
+    EXPECT_THROW(ModContext(BigInteger(0)), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, RangeAggregates)
+{
+    std::mt19937_64 rng(17);
+    std::vector<BigInteger> values;
+    std::vector<BigInteger> weights;
+    for (std::size_t i = 0; i < 300; i++)
+    {
+        std::string digits = random_digits(rng, 1 + rng() % 400);
+        values.emplace_back(i % 3 == 0 ? "-" + digits : digits);
+        weights.emplace_back(random_digits(rng, 1 + rng() % 50));
+    }
+    values.emplace_back(0);
+    weights.emplace_back(1);
+
+    BigInteger total(0);
+    BigInteger all(1);
+    BigInteger weighted(0);
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        total += values[i];
+        all *= values[i];
+        weighted += values[i] * weights[i];
+    }
+    EXPECT_EQ(sum(values.begin(), values.end()), total);
+    EXPECT_EQ(product(values.begin(), values.end() - 1) * values.back(), all);
+    EXPECT_EQ(product(values.begin(), values.end()), BigInteger(0));
+    EXPECT_EQ(dot(values.begin(), values.end(), weights.begin()), weighted);
+
+    // Parallel chunks must give the same results
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    const std::size_t saved_threads = BigInteger::thread_count();
+    BigInteger::thresholds().parallel = 8;
+    BigInteger::set_thread_count(4);
+    EXPECT_EQ(sum(BigIntegerExecution::parallel, values.begin(), values.end()), total);
+    EXPECT_EQ(product(BigIntegerExecution::parallel, values.begin(), values.end() - 1),
+              product(values.begin(), values.end() - 1));
+    EXPECT_EQ(dot(BigIntegerExecution::parallel, values.begin(), values.end(), weights.begin()), weighted);
+    BigInteger::set_thread_count(saved_threads);
+    BigInteger::thresholds() = saved;
+
+    // Other integer ranges, cancellation and empty ranges
+    std::vector<long long> small = { 9223372036854775807LL, -5, 9223372036854775807LL, -9223372036854775807LL };
+    EXPECT_EQ(sum(small.begin(), small.end()), BigInteger("9223372036854775802"));
+    EXPECT_EQ(product(small.begin(), small.begin() + 2), BigInteger("-46116860184273879035"));
+    std::vector<BigInteger> cancelling = { BigInteger(std::string(60, '9')), -BigInteger(std::string(60, '9')) };
+    EXPECT_EQ(sum(cancelling.begin(), cancelling.end()), BigInteger(0));
+    EXPECT_FALSE(sum(cancelling.begin(), cancelling.end()).is_negative());
+    EXPECT_EQ(sum(small.end(), small.end()), BigInteger(0));
+    EXPECT_EQ(product(small.end(), small.end()), BigInteger(1));
+    EXPECT_EQ(dot(small.end(), small.end(), small.begin()), BigInteger(0));
+    std::vector<BigInteger> uninitialized(2);
+    EXPECT_THROW(sum(uninitialized.begin(), uninitialized.end()), std::invalid_argument);
+    EXPECT_THROW(product(uninitialized.begin(), uninitialized.end()), std::invalid_argument);
+}
+
+// A pool thread waiting on a parallel multiplication runs other queued tree
+// and chunk tasks, whose products must not share its workspace. Values of
+// about 150 limbs put every pairwise product above the parallel threshold.
+TEST(BigIntegerTest, ParallelAggregatesAboveThreshold)
+{
+    std::mt19937_64 rng(29);
+    std::vector<BigInteger> values;
+    std::vector<BigInteger> weights;
+    for (std::size_t i = 0; i < 128; i++)
+    {
+        values.emplace_back(random_digits(rng, 2890));
+        weights.emplace_back(random_digits(rng, 2890));
+    }
+    const BigInteger expected_product = product(values.begin(), values.end());
+    const BigInteger expected_dot = dot(values.begin(), values.end(), weights.begin());
+
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    const std::size_t saved_threads = BigInteger::thread_count();
+    BigInteger::thresholds().parallel = 64;
+    BigInteger::set_thread_count(8);
+    for (int round = 0; round < 6; round++)
+    {
+        EXPECT_EQ(product(BigIntegerExecution::parallel, values.begin(), values.end()), expected_product);
+        EXPECT_EQ(dot(BigIntegerExecution::parallel, values.begin(), values.end(), weights.begin()), expected_dot);
+    }
+    BigInteger::set_thread_count(saved_threads);
+    BigInteger::thresholds() = saved;
+}
+
+TEST(BigIntegerTest, Combinatorics)
+{
+    BigInteger expected(1);
+    for (std::uint64_t n = 0; n <= 600; n++)
+    {
+        if (n > 0)
+        {
+            expected *= BigInteger(n);
+        }
+        if (n % 37 == 0 || n < 25)
+        {
+            EXPECT_EQ(factorial(n), expected);
+        }
+    }
+    EXPECT_EQ(factorial(25), BigInteger("15511210043330985984000000"));
+
+    // Pascal's rule over the whole of row 200 exercises both binomial paths
+    for (std::uint64_t k = 0; k <= 200; k++)
+    {
+        EXPECT_EQ(binomial(201, k + 1), binomial(200, k) + binomial(200, k + 1));
+    }
+    EXPECT_EQ(binomial(100, 50), BigInteger("100891344545564193334812497256"));
+    EXPECT_EQ(binomial(4000000000ULL, 2), BigInteger("7999999998000000000"));
+    EXPECT_EQ(binomial(5, 6), BigInteger(0));
+    EXPECT_EQ(binomial(0, 0), BigInteger(1));
+    EXPECT_EQ(factorial(10000) / (factorial(3000) * factorial(7000)), binomial(10000, 3000));
+
+    EXPECT_EQ(primorial(1), BigInteger(1));
+    EXPECT_EQ(primorial(30), BigInteger(6469693230LL));
+    EXPECT_EQ(primorial(1000) % BigInteger(997), BigInteger(0));
+    EXPECT_EQ(primorial(1000) / primorial(996), BigInteger(997));
+
+    BigInteger base("-123456789012345678901");
+    BigInteger power(1);
+    for (std::uint64_t exponent = 0; exponent < 40; exponent++)
+    {
+        EXPECT_EQ(pow(base, exponent), power);
+        power *= base;
+    }
+    EXPECT_EQ(pow(BigInteger(0), 0), BigInteger(1));
+    EXPECT_EQ(pow(BigInteger(2), 200), BigInteger("1606938044258990275541962092341162602522202993782792835301376"));
+}
+
+static BigInteger reference_gcd(BigInteger a, BigInteger b)
+{
+    if (a.is_negative())
+    {
+        a = -a;
+    }
+    if (b.is_negative())
+    {
+        b = -b;
+    }
+    while (b.is_positive())
+    {
+        BigInteger r = a % b;
+        a = std::move(b);
+        b = std::move(r);
+    }
+    return a;
+}
+
+TEST(BigIntegerTest, Gcd)
+{
+    std::mt19937_64 rng(19);
+    BigIntegerThresholds saved = BigInteger::thresholds();
+    // The second pass takes half-GCD from a few limbs on
+    for (std::size_t half_gcd : { saved.half_gcd, std::size_t(4) })
+    {
+        BigInteger::thresholds().half_gcd = half_gcd;
+        for (std::size_t digits : { 5, 19, 38, 60, 200, 900, 3000 })
+        {
+            BigInteger factor(random_digits(rng, digits / 3 + 1));
+            BigInteger a = BigInteger(random_digits(rng, digits)) * factor;
+            BigInteger b = -BigInteger(random_digits(rng, digits + rng() % 40)) * factor;
+            BigInteger g = gcd(a, b);
+            EXPECT_EQ(g, reference_gcd(a, b));
+            EXPECT_EQ(gcd(b, a), g);
+            EXPECT_EQ(lcm(a, b), a * -b / g);
+
+            std::tuple<BigInteger, BigInteger, BigInteger> bezout = extended_gcd(a, b);
+            EXPECT_EQ(std::get<0>(bezout), g);
+            EXPECT_EQ(a * std::get<1>(bezout) + b * std::get<2>(bezout), g);
+            BigInteger bound = -b / g;
+            EXPECT_TRUE(std::get<1>(bezout) + std::get<1>(bezout) <= bound);
+            EXPECT_TRUE(-(std::get<1>(bezout) + std::get<1>(bezout)) <= bound);
+
+            BigInteger m = a / g;
+            BigInteger value = b / g;
+            BigInteger inverse = mod_inverse(value, m);
+            EXPECT_FALSE(inverse.is_negative());
+            EXPECT_TRUE(inverse < m);
+            EXPECT_EQ((value * inverse - BigInteger(1)) % m, BigInteger(0));
+        }
+
+        // Consecutive Fibonacci numbers make every quotient one
+        BigInteger f0(0);
+        BigInteger f1(1);
+        for (int i = 0; i < 3000; i++)
+        {
+            f0 += f1;
+            std::swap(f0, f1);
+        }
+        EXPECT_EQ(gcd(f1, f0), BigInteger(1));
+        std::tuple<BigInteger, BigInteger, BigInteger> bezout = extended_gcd(f1, f0);
+        EXPECT_EQ(f1 * std::get<1>(bezout) + f0 * std::get<2>(bezout), BigInteger(1));
+    }
+    BigInteger::thresholds() = saved;
+
+    EXPECT_EQ(gcd(BigInteger(0), BigInteger(0)), BigInteger(0));
+    EXPECT_EQ(gcd(BigInteger(-12), BigInteger(0)), BigInteger(12));
+    EXPECT_EQ(lcm(BigInteger(0), BigInteger(5)), BigInteger(0));
+    EXPECT_EQ(std::get<1>(extended_gcd(BigInteger(-7), BigInteger(0))), BigInteger(-1));
+    EXPECT_EQ(mod_inverse(BigInteger(-7), BigInteger(12)), BigInteger(5));
+    EXPECT_THROW(mod_inverse(BigInteger(9), BigInteger(12)), std::invalid_argument);
+    EXPECT_THROW(mod_inverse(BigInteger(9), BigInteger(0)), std::invalid_argument);
+    EXPECT_THROW(gcd(BigInteger(), BigInteger(1)), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, Roots)
+{
+    std::mt19937_64 rng(23);
+    for (std::size_t digits : { 1, 10, 19, 20, 39, 40, 100, 1000, 8000 })
+    {
+        BigInteger value(random_digits(rng, digits));
+        for (std::uint64_t k : { 2, 3, 5, 64 })
+        {
+            BigInteger root = iroot(value, k);
+            EXPECT_TRUE(pow(root, k) <= value);
+            EXPECT_TRUE(pow(root + BigInteger(1), k) > value);
+        }
+        BigInteger root = isqrt(value);
+        EXPECT_EQ(root, iroot(value, 2));
+        EXPECT_TRUE(is_perfect_square(root * root));
+        EXPECT_EQ(isqrt(root * root), root);
+        EXPECT_EQ(isqrt(root * root - BigInteger(1)), root - BigInteger(1));
+        EXPECT_FALSE(is_perfect_square(root * root + BigInteger(1)));
+        EXPECT_EQ(iroot(-pow(root, 3), 3), -root);
+    }
+
+    // Every square below 2000 and nothing else
+    std::size_t squares = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        squares += is_perfect_square(BigInteger(i));
+    }
+    EXPECT_EQ(squares, 45u);
+    EXPECT_FALSE(is_perfect_square(BigInteger(-4)));
+    EXPECT_EQ(isqrt(BigInteger(0)), BigInteger(0));
+    EXPECT_EQ(iroot(BigInteger(7), 1), BigInteger(7));
+    EXPECT_EQ(iroot(BigInteger("340282366920938463463374607431768211455"), 128), BigInteger(1));
+    EXPECT_EQ(iroot(BigInteger("340282366920938463463374607431768211456"), 128), BigInteger(2));
+    // Degrees at or past the bit length, up to the largest k
+    const BigInteger big = BigInteger(1) << 100;
+    EXPECT_EQ(iroot(big, 99), BigInteger(2));
+    EXPECT_EQ(iroot(big, 100), BigInteger(2));
+    EXPECT_EQ(iroot(big, 101), BigInteger(1));
+    EXPECT_EQ(iroot(big, 1ull << 40), BigInteger(1));
+    EXPECT_EQ(iroot(-big, (1ull << 40) + 1), BigInteger(-1));
+    EXPECT_EQ(iroot(big, UINT64_MAX), BigInteger(1));
+    EXPECT_EQ(iroot(big - BigInteger(1), 50), BigInteger(3));
+    EXPECT_THROW(isqrt(BigInteger(-1)), std::invalid_argument);
+    EXPECT_THROW(iroot(BigInteger(-8), 2), std::invalid_argument);
+    EXPECT_THROW(iroot(BigInteger(8), 0), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, BinarySerialization)
+{
+    std::mt19937_64 rng(29);
+    std::vector<BigInteger> values = { BigInteger(0), BigInteger(1), BigInteger(-1),
+                                       BigInteger("18446744073709551616"), BigInteger("-340282366920938463463374607431768211456") };
+    for (std::size_t digits : { 30, 400, 5000 })
+    {
+        values.emplace_back(random_digits(rng, digits));
+        values.emplace_back("-" + random_digits(rng, digits));
+    }
+
+    // Back-to-back records in one 8-byte aligned buffer
+    std::size_t total = 0;
+    for (const BigInteger& value : values)
+    {
+        total += serialized_size(value);
+    }
+    EXPECT_EQ(serialized_size(BigInteger(0)), 16u);
+    EXPECT_EQ(serialized_size(BigInteger(-1)), 24u);
+    std::vector<std::uint64_t> storage(total / 8);
+    unsigned char* first = reinterpret_cast<unsigned char*>(storage.data());
+    unsigned char* last = first + total;
+    unsigned char* out = first;
+    for (const BigInteger& value : values)
+    {
+        out = serialize(value, out, last);
+        ASSERT_NE(out, nullptr);
+    }
+    EXPECT_EQ(out, last);
+    EXPECT_EQ(serialize(BigInteger(1), last - 8, last), nullptr);
+
+    const unsigned char* in = first;
+    const unsigned char* view_in = first;
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        EXPECT_EQ(deserialize(in, last), values[i]);
+        BigIntegerView view = BigIntegerView::read(view_in, last);
+        EXPECT_EQ(view, values[i]);
+        EXPECT_EQ(view.to_big_integer(), values[i]);
+        EXPECT_EQ(view.to_string(), values[i].to_string());
+
+        // Arithmetic on the limbs in place matches BigInteger's
+        const BigInteger& other = values[(i + 3) % values.size()];
+        EXPECT_EQ(view + other, values[i] + other);
+        EXPECT_EQ(view - other, values[i] - other);
+        EXPECT_EQ(view * other, values[i] * other);
+        EXPECT_EQ(compare(view, other), values[i] == other ? 0 : (view - other).is_negative() ? -1 : 1);
+        if (other.is_positive() || other.is_negative())
+        {
+            EXPECT_EQ(view / other, values[i] / other);
+            EXPECT_EQ(view % other, values[i] % other);
+        }
+    }
+    EXPECT_EQ(in, last);
+    EXPECT_EQ(view_in, last);
+    EXPECT_THROW(BigIntegerView(values[0]) / BigInteger(0), std::invalid_argument);
+
+    // Damaged records are refused
+    std::vector<unsigned char> record(serialized_size(values[3]));
+    serialize(values[3], record.data(), record.data() + record.size());
+    std::vector<unsigned char> bad = record;
+    bad[0] = 'X';
+    in = bad.data();
+    EXPECT_THROW(deserialize(in, bad.data() + bad.size()), std::invalid_argument);
+    bad = record;
+    bad[4] = 2;
+    in = bad.data();
+    EXPECT_THROW(deserialize(in, bad.data() + bad.size()), std::invalid_argument);
+    in = record.data();
+    EXPECT_THROW(deserialize(in, record.data() + record.size() - 1), std::invalid_argument);
+    bad = record;
+    bad[bad.size() - 1] = 0;
+    bad[bad.size() - 8] = 0;
+    in = bad.data();
+    EXPECT_THROW(deserialize(in, bad.data() + bad.size()), std::invalid_argument);
+    EXPECT_EQ(in, bad.data());
+    std::vector<std::uint64_t> shifted(4);
+    unsigned char* odd = reinterpret_cast<unsigned char*>(shifted.data()) + 4;
+    serialize(BigInteger(7), odd, odd + 24);
+    in = odd;
+    EXPECT_THROW(BigIntegerView::read(in, odd + 24), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, StreamingParse)
+{
+    std::mt19937_64 rng(31);
+    // Lengths around the parser's block size and well beyond it
+    for (std::size_t digits : { 1, 19, 40, 1215, 1216, 1217, 5000, 77777 })
+    {
+        std::string text = random_digits(rng, digits);
+        if (digits % 2)
+        {
+            text = "-" + text;
+        }
+        BigInteger expected(text);
+
+        // Blocks of every awkward size, ending with a non-digit
+        BigIntegerParser parser;
+        std::string input = text + "x123";
+        std::size_t taken = 0;
+        std::size_t step = 1;
+        for (std::size_t pos = 0; pos < input.size(); pos += step, step = step * 3 % 1000 + 1)
+        {
+            const std::size_t end = std::min(input.size(), pos + step);
+            taken += parser.feed(input.data() + pos, input.data() + end);
+        }
+        EXPECT_TRUE(parser.done());
+        EXPECT_EQ(taken, text.size());
+        EXPECT_EQ(parser.finish(), expected);
+
+        std::size_t offset = 0;
+        BigInteger pulled = BigIntegerParser::parse([&](char* buffer, std::size_t size)
+        {
+            const std::size_t count = std::min(size, text.size() - offset);
+            std::copy(text.data() + offset, text.data() + offset + count, buffer);
+            offset += count;
+            return count;
+        });
+        EXPECT_EQ(pulled, expected);
+
+        std::istringstream stream("  " + text + " 42 abc");
+        BigInteger first;
+        BigInteger second;
+        stream >> first >> second;
+        EXPECT_EQ(first, expected);
+        EXPECT_EQ(second, BigInteger(42));
+        BigInteger untouched(7);
+        EXPECT_FALSE(stream >> untouched);
+        EXPECT_EQ(untouched, BigInteger(7));
+    }
+
+    // Leading zeros, negative zero, end of input and a missing number
+    std::istringstream stream("-000000000000000000000000000000000000000000000000000000000000");
+    BigInteger zero;
+    EXPECT_TRUE(stream >> zero);
+    EXPECT_TRUE(stream.eof());
+    EXPECT_EQ(zero, BigInteger(0));
+    EXPECT_FALSE(zero.is_negative());
+    BigIntegerParser parser;
+    EXPECT_EQ(parser.feed("-", "-" + 1), 1u);
+    EXPECT_EQ(parser.feed("-1", "-1" + 2), 0u);
+    EXPECT_THROW(parser.finish(), std::invalid_argument);
+    EXPECT_EQ(parser.feed("12", "12" + 2), 2u);
+    EXPECT_EQ(parser.finish(), BigInteger(12));
+    EXPECT_THROW(BigInteger("12a"), std::invalid_argument);
+    EXPECT_THROW(BigInteger("-"), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, ThreeWayCompare)
+{
+    BigInteger big("123456789012345678901234567890123456789");
+    BigInteger bigger = big + BigInteger(1);
+    BigInteger small("98765");
+    BigInteger zero(0);
+
+    EXPECT_EQ(compare(big, big), 0);
+    EXPECT_EQ(compare(big, bigger), -1);
+    EXPECT_EQ(compare(bigger, big), 1);
+    EXPECT_EQ(compare(small, big), -1);
+    EXPECT_EQ(compare(-small, -big), 1);
+    EXPECT_EQ(compare(-big, -bigger), 1);
+    EXPECT_EQ(compare(-big, small), -1);
+    EXPECT_EQ(compare(zero, -small), 1);
+    EXPECT_EQ(compare(-zero, zero), 0);
+    EXPECT_TRUE(-bigger < -big);
+    EXPECT_TRUE(-big <= -big);
+    EXPECT_TRUE(-small > -big);
+
+    // Sorting puts negatives in numeric order
+    std::vector<BigInteger> values = {bigger, -small, zero, -big, small, -bigger, big};
+    std::sort(values.begin(), values.end());
+    std::vector<BigInteger> expected = {-bigger, -big, -small, zero, small, big, bigger};
+    EXPECT_EQ(values, expected);
+
+    BigInteger uninitBigInt;
+    EXPECT_THROW(compare(uninitBigInt, big), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, Hash)
+{
+    std::hash<BigInteger> hasher;
+    BigInteger a("340282366920938463463374607431768211457");
+    EXPECT_EQ(hasher(a), hasher(BigInteger("340282366920938463463374607431768211457")));
+    EXPECT_EQ(hasher(BigInteger(0)), hasher(-BigInteger(0)));
+    EXPECT_NE(hasher(a), hasher(-a));
+
+    // Distinct values dedupe exactly and spread over the buckets
+    std::unordered_set<BigInteger> seen;
+    BigInteger value(1);
+    for (int i = 0; i < 2000; i++)
+    {
+        seen.insert(value);
+        seen.insert(value);
+        seen.insert(-value);
+        value *= BigInteger(3);
+    }
+    EXPECT_EQ(seen.size(), 4000u);
+    std::unordered_set<std::size_t> hashes;
+    for (const BigInteger& v : seen)
+    {
+        hashes.insert(hasher(v));
+    }
+    EXPECT_EQ(hashes.size(), seen.size());
+
+    std::unordered_map<BigInteger, int> counts;
+    counts[BigInteger("18446744073709551616")]++;
+    counts[BigInteger(1) + BigInteger("18446744073709551615")]++;
+    EXPECT_EQ(counts.size(), 1u);
+    EXPECT_EQ(counts.begin()->second, 2);
+
+    BigInteger uninitBigInt;
+    EXPECT_THROW(hasher(uninitBigInt), std::invalid_argument);
+}
+
+TEST(BigIntegerTest, BitwiseOperators)
+{
+    // Against the built-in operators, which are two's complement
+    for (long long x = -70; x <= 70; x += 3)
+    {
+        for (long long y = -70; y <= 70; y += 7)
+        {
+            EXPECT_EQ(BigInteger(x) & BigInteger(y), BigInteger(x & y));
+            EXPECT_EQ(BigInteger(x) | BigInteger(y), BigInteger(x | y));
+            EXPECT_EQ(BigInteger(x) ^ BigInteger(y), BigInteger(x ^ y));
+        }
+        EXPECT_EQ(~BigInteger(x), BigInteger(~x));
+        for (std::size_t bits : {0, 1, 5, 63})
+        {
+            EXPECT_EQ(BigInteger(x) << bits, BigInteger(x) * pow(BigInteger(2), bits));
+            EXPECT_EQ(BigInteger(x) >> bits, BigInteger(x >> bits));
+        }
+    }
+
+    // Multi-limb identities, with negatives and operands of different lengths
+    std::mt19937_64 rng(23);
+    for (int round = 0; round < 40; round++)
+    {
+        BigInteger a((round % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 120));
+        BigInteger b((round % 3 ? "" : "-") + random_digits(rng, 1 + rng() % 120));
+        EXPECT_EQ((a & b) + (a | b), a + b);
+        EXPECT_EQ(a ^ b, (a | b) - (a & b));
+        EXPECT_EQ(~a, -a - BigInteger(1));
+        EXPECT_EQ(~(a & b), ~a | ~b);
+        EXPECT_EQ(a & ~a, BigInteger(0));
+        EXPECT_EQ(a ^ a, BigInteger(0));
+
+        std::size_t bits = rng() % 300;
+        BigInteger power = pow(BigInteger(2), bits);
+        EXPECT_EQ(a << bits, a * power);
+        BigInteger floor = a / power;
+        if (a.is_negative() && floor * power != a)
+        {
+            floor -= BigInteger(1);
+        }
+        EXPECT_EQ(a >> bits, floor);
+
+        BigInteger c = a;
+        c <<= bits;
+        c >>= bits;
+        EXPECT_EQ(c, a);
+        c &= b;
+        EXPECT_EQ(c, a & b);
+        c = a;
+        c |= b;
+        EXPECT_EQ(c, a | b);
+        c = b;
+        c ^= a;
+        EXPECT_EQ(c, a ^ b);
+        c = a;
+        c &= c;
+        EXPECT_EQ(c, a);
+    }
+
+    BigInteger x("-340282366920938463463374607431768211456"); // -2^128
+    EXPECT_EQ(x >> 200, BigInteger(-1));
+    EXPECT_EQ(-x >> 200, BigInteger(0));
+    EXPECT_EQ(x & BigInteger("-18446744073709551616"), x);
+    EXPECT_EQ(x | (x >> 64), x >> 64);
+    EXPECT_EQ(BigInteger(0) << 1000, BigInteger(0));
+
+    BigInteger uninitBigInt;
+    EXPECT_THROW(uninitBigInt << 1, std::invalid_argument);
+    EXPECT_THROW(x & uninitBigInt, std::invalid_argument);
+    EXPECT_THROW(~uninitBigInt, std::invalid_argument);
+}
+
+TEST(BigIntegerTest, BitQueries)
+{
+    for (long long x = -300; x <= 300; x++)
+    {
+        unsigned long long bits = static_cast<unsigned long long>(x < 0 ? ~x : x);
+        std::size_t length = bits == 0 ? 0 : 64 - __builtin_clzll(bits);
+        EXPECT_EQ(BigInteger(x).bit_length(), length);
+        EXPECT_EQ(BigInteger(x).popcount(), static_cast<std::size_t>(__builtin_popcountll(bits)));
+        for (std::size_t index : {0, 1, 4, 8, 63, 64, 500})
+        {
+            EXPECT_EQ(BigInteger(x).test_bit(index), ((x >> std::min<std::size_t>(index, 63)) & 1) != 0);
+        }
+    }
+
+    // -2^130 is 130 zero bits under infinite ones
+    BigInteger x = -(BigInteger(1) << 130);
+    EXPECT_EQ(x.bit_length(), 130u);
+    EXPECT_EQ(x.popcount(), 130u);
+    EXPECT_FALSE(x.test_bit(0));
+    EXPECT_FALSE(x.test_bit(129));
+    EXPECT_TRUE(x.test_bit(130));
+    EXPECT_TRUE(x.test_bit(100000));
+    EXPECT_EQ((x - BigInteger(1)).bit_length(), 131u);
+    EXPECT_EQ((-x).bit_length(), 131u);
+    EXPECT_EQ((-x).popcount(), 1u);
+
+    std::mt19937_64 rng(31);
+    BigInteger y("-" + random_digits(rng, 200));
+    std::size_t set = 0;
+    for (std::size_t i = 0; i < y.bit_length(); i++)
+    {
+        set += y.test_bit(i) ? 0 : 1;
+        EXPECT_EQ(y.test_bit(i), !(~y).test_bit(i));
+    }
+    EXPECT_EQ(y.popcount(), set);
+
+    BigInteger uninitBigInt;
+    EXPECT_THROW(uninitBigInt.bit_length(), std::invalid_argument);
+}
+
+// value reduced into [-2^(bits-1), 2^(bits-1)) as two's complement wraps it
+static BigInteger wrap_to(const BigInteger& value, std::size_t bits)
+{
+    BigInteger low = value & ((BigInteger(1) << bits) - BigInteger(1));
+    return low.test_bit(bits - 1) ? low - (BigInteger(1) << bits) : low;
+}
+
+TEST(BigIntegerTest, FixedBigIntegerMatchesBigInteger)
+{
+    typedef FixedBigInteger<256> Checked;
+    typedef FixedBigInteger<256, FixedBigIntegerOverflow::wrapping> Wrapping;
+    std::mt19937_64 rng(24);
+    const BigInteger limit = BigInteger(1) << 255;
+
+    for (int round = 0; round < 300; round++)
+    {
+        // Sizes from one limb to the full width, so some results overflow
+        BigInteger a(random_digits(rng, 1 + rng() % 77));
+        BigInteger b(random_digits(rng, 1 + rng() % 77));
+        a = wrap_to(round % 2 ? -a : a, 256);
+        b = wrap_to(round % 3 ? b : -b, 256);
+        const Checked x(a);
+        const Checked y(b);
+        EXPECT_EQ(x.to_big_integer(), a);
+        EXPECT_EQ(Checked(a.to_string()), x);
+        EXPECT_EQ(x.to_string(), a.to_string());
+
+        const BigInteger exact[] = { a + b, a - b, a * b, a << (round % 70) };
+        for (int op = 0; op < 4; op++)
+        {
+            auto apply = [&](auto u, auto v)
+            {
+                switch (op)
+                {
+                    case 0: return u + v;
+                    case 1: return u - v;
+                    case 2: return u * v;
+                    default: return u << (round % 70);
+                }
+            };
+            const bool fits = exact[op] >= -limit && exact[op] < limit;
+            if (fits)
+            {
+                EXPECT_EQ(apply(x, y).to_big_integer(), exact[op]);
+            }
+            else
+            {
+                EXPECT_THROW(apply(x, y), std::invalid_argument);
+            }
+            EXPECT_EQ(apply(Wrapping(a), Wrapping(b)).to_big_integer(), wrap_to(exact[op], 256));
+        }
+
+        if (b != BigInteger(0))
+        {
+            EXPECT_EQ((x / y).to_big_integer(), a / b);
+            EXPECT_EQ((x % y).to_big_integer(), a % b);
+        }
+        EXPECT_EQ((x >> (round % 300)).to_big_integer(), a >> (round % 300));
+        EXPECT_EQ((x & y).to_big_integer(), a & b);
+        EXPECT_EQ((x | y).to_big_integer(), a | b);
+        EXPECT_EQ((x ^ y).to_big_integer(), a ^ b);
+        EXPECT_EQ((~x).to_big_integer(), ~a);
+        EXPECT_EQ(compare(x, y), compare(a, b));
+        EXPECT_EQ(x.bit_length(), a.bit_length());
+        EXPECT_EQ(x.popcount(), a.popcount());
+        EXPECT_EQ(x.test_bit(round), a.test_bit(round));
+    }
+
+    // Divisors of every length against full-width dividends
+    for (int round = 0; round < 200; round++)
+    {
+        typedef FixedBigInteger<512> Wide;
+        BigInteger a = wrap_to(BigInteger(random_digits(rng, 150)), 512);
+        BigInteger b(random_digits(rng, 1 + rng() % 150));
+        b = wrap_to(round % 2 ? -b : b, 512);
+        if (b == BigInteger(0))
+        {
+            continue;
+        }
+        EXPECT_EQ((Wide(a) / Wide(b)).to_big_integer(), a / b);
+        EXPECT_EQ((Wide(a) % Wide(b)).to_big_integer(), a % b);
+    }
+}
+
+TEST(BigIntegerTest, FixedBigIntegerLimits)
+{
+    typedef FixedBigInteger<128> Checked;
+    typedef FixedBigInteger<128, FixedBigIntegerOverflow::wrapping> Wrapping;
+
+    // Everything is usable in constant expressions
+    constexpr Checked a("-170141183460469231731687303715884105728");
+    static_assert(a == Checked::min(), "parsed at compile time");
+    static_assert(Checked(12345) * Checked(-6789) / Checked(7) == Checked(-11972886), "");
+    static_assert((Checked(1) << 100 >> 98) == Checked(4), "");
+    static_assert(Wrapping::max() + Wrapping(1) == Wrapping::min(), "wraps like int");
+    static_assert(sizeof(FixedBigInteger<4096>) == 512, "limbs stored inline");
+
+    EXPECT_EQ(Checked::min().to_string(), "-170141183460469231731687303715884105728");
+    EXPECT_EQ(Checked::max().to_string(), "170141183460469231731687303715884105727");
+    EXPECT_THROW(Checked::max() + Checked(1), std::invalid_argument);
+    EXPECT_THROW(Checked::min() - Checked(1), std::invalid_argument);
+    EXPECT_THROW(-Checked::min(), std::invalid_argument);
+    EXPECT_THROW(Checked::min() / Checked(-1), std::invalid_argument);
+    EXPECT_THROW(Checked(1) << 127, std::invalid_argument);
+    EXPECT_EQ(Checked(-1) << 127, Checked::min());
+    EXPECT_THROW(Checked(1) / Checked(0), std::invalid_argument);
+    EXPECT_THROW(Checked("170141183460469231731687303715884105728"), std::invalid_argument);
+    EXPECT_THROW(Checked("12a"), std::invalid_argument);
+    EXPECT_THROW(Checked(BigInteger(1) << 200), std::invalid_argument);
+    EXPECT_THROW(FixedBigInteger<64>(~0ULL), std::invalid_argument);
+
+    EXPECT_EQ(Wrapping::min() / Wrapping(-1), Wrapping::min());
+    EXPECT_EQ(-Wrapping::min(), Wrapping::min());
+    EXPECT_EQ(Wrapping(BigInteger(1) << 200), Wrapping(0));
+    EXPECT_EQ(Wrapping((BigInteger(1) << 128) + BigInteger(5)), Wrapping(5));
+    EXPECT_EQ(Wrapping("340282366920938463463374607431768211455"), Wrapping(-1));
+    typedef FixedBigInteger<64, FixedBigIntegerOverflow::wrapping> Wrapping64;
+    EXPECT_EQ(Wrapping64(~0ULL), Wrapping64(-1));
+
+    std::istringstream in("-98765432109876543210 12");
+    Checked x;
+    Checked y;
+    in >> x >> y;
+    EXPECT_EQ(x, Checked("-98765432109876543210"));
+    EXPECT_EQ(y, Checked(12));
+    std::ostringstream out;
+    out << x * y;
+    EXPECT_EQ(out.str(), "-1185185185318518518520");
+
+    std::unordered_set<Checked> seen = { Checked(1), Checked("1"), Checked(-1), Checked::min() };
+    EXPECT_EQ(seen.size(), 3u);
+}
+
+TEST(BigIntegerTest, BigLiteral)
+{
+    // Converted while compiling into static limbs
+    constexpr BigIntegerView big = 340282366920938463463374607431768211457_big;
+    static_assert(big.size() == 3, "2^128 + 1 takes three limbs");
+    static_assert(big.data()[0] == 1 && big.data()[1] == 0 && big.data()[2] == 1, "");
+    static_assert((-big).is_negative() && !(-(-big)).is_negative(), "");
+    static_assert(!(-0_big).is_negative() && (0_big).size() == 1, "");
+    static_assert((18'446'744'073'709'551'615_big).data()[0] == ~0ULL, "separators skipped");
+
+    EXPECT_EQ(big.to_big_integer(), BigInteger("340282366920938463463374607431768211457"));
+    EXPECT_EQ(-big, BigInteger("-340282366920938463463374607431768211457"));
+    EXPECT_EQ((0_big).to_string(), "0");
+    EXPECT_EQ((-7_big).to_string(), "-7");
+
+    // A long literal, and mixed arithmetic with BigInteger
+    const BigIntegerView p = 57896044618658097711785492504343953926634992332820282019728792003956564819949_big;
+    const BigInteger two_255 = BigInteger(1) << 255;
+    EXPECT_EQ(p, two_255 - BigInteger(19));
+    EXPECT_EQ(two_255 - p, BigInteger(19));
+    EXPECT_EQ((p * p) % p, BigInteger(0));
+    EXPECT_TRUE(two_255 > p);
+    EXPECT_EQ(p.data(), (57896044618658097711785492504343953926634992332820282019728792003956564819949_big).data());
+
+    const std::string digits(400, '9');
+    EXPECT_EQ((9999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999999_big).to_string(), digits);
+}
+
 int main() 
 {
     ::testing::InitGoogleTest();
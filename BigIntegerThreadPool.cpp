@@ -0,0 +1,320 @@
+#include "BigInteger.h"
+#include "BigIntegerInternal.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <thread>
+
+// Work-stealing pool for the parallel multiplication paths. Every worker owns
+// a deque: it pushes and pops its own tasks at the back, so nested subproducts
+// stay hot in its cache, and idle workers steal the oldest (largest) tasks
+// from the front of the others. Threads outside the pool share one extra
+// queue.
+
+namespace bigint_detail
+{
+    namespace
+    {
+        struct Task
+        {
+            std::function<void()> work;
+            TaskGroup* group;
+        };
+
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        class ThreadPool
+        {
+            public:
+                explicit ThreadPool(std::size_t workers);
+                ~ThreadPool();
+
+                void push(Task task);
+
+                // Runs one queued task on the calling thread; false if every
+                // queue was empty.
+                bool run_one();
+
+            private:
+                std::vector<std::unique_ptr<WorkQueue>> queues;
+                std::vector<std::thread> threads;
+                std::atomic<std::size_t> queued;
+                std::mutex sleep_mutex;
+                std::condition_variable wake;
+                bool stopping;
+
+                std::size_t own_queue() const;
+                bool pop(std::size_t index, Task& task);
+                void work(std::size_t index);
+        };
+
+        thread_local const ThreadPool* current_pool = nullptr;
+        thread_local std::size_t current_index = 0;
+
+        ThreadPool::ThreadPool(std::size_t workers)
+            : queued(0), stopping(false)
+        {
+            for (std::size_t i = 0; i <= workers; i++)
+            {
+                queues.push_back(std::make_unique<WorkQueue>());
+            }
+            for (std::size_t i = 0; i < workers; i++)
+            {
+                threads.emplace_back(&ThreadPool::work, this, i);
+            }
+        }
+
+        ThreadPool::~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // Workers use their own queue, everyone else the shared last one
+        std::size_t ThreadPool::own_queue() const
+        {
+            return current_pool == this ? current_index : queues.size() - 1;
+        }
+
+        void ThreadPool::push(Task task)
+        {
+            WorkQueue& queue = *queues[own_queue()];
+            // Counted before it is visible, so a pop can never take queued
+            // below zero
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                queued++;
+            }
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            wake.notify_one();
+        }
+
+        bool ThreadPool::pop(std::size_t index, Task& task)
+        {
+            for (std::size_t k = 0; k < queues.size(); k++)
+            {
+                WorkQueue& queue = *queues[(index + k) % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty())
+                {
+                    if (k == 0)
+                    {
+                        task = std::move(queue.tasks.back());
+                        queue.tasks.pop_back();
+                    }
+                    else
+                    {
+                        task = std::move(queue.tasks.front());
+                        queue.tasks.pop_front();
+                    }
+                    queued--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static void execute(Task& task)
+        {
+            std::exception_ptr failure;
+            try
+            {
+                task.work();
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+            task.group->finish(failure);
+        }
+
+        bool ThreadPool::run_one()
+        {
+            Task task;
+            if (!pop(own_queue(), task))
+            {
+                return false;
+            }
+            execute(task);
+            return true;
+        }
+
+        void ThreadPool::work(std::size_t index)
+        {
+            current_pool = this;
+            current_index = index;
+            while (true)
+            {
+                Task task;
+                if (pop(index, task))
+                {
+                    execute(task);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                wake.wait(lock, [this] { return stopping || queued > 0; });
+                if (stopping && queued == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        struct PoolState
+        {
+            std::mutex mutex;
+            std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+            std::unique_ptr<ThreadPool> pool;
+        };
+
+        PoolState& pool_state()
+        {
+            static PoolState state;
+            return state;
+        }
+
+        // The pool is started on first use; null when running single threaded.
+        ThreadPool* shared_pool()
+        {
+            PoolState& state = pool_state();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.threads <= 1)
+            {
+                return nullptr;
+            }
+            if (!state.pool)
+            {
+                state.pool = std::make_unique<ThreadPool>(state.threads - 1);
+            }
+            return state.pool.get();
+        }
+    }
+
+    TaskGroup::TaskGroup()
+        : pending(0)
+    {
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void TaskGroup::run(std::function<void()> work)
+    {
+        ThreadPool* pool = shared_pool();
+        if (!pool)
+        {
+            work();
+            return;
+        }
+        pending++;
+        pool->push(Task{ std::move(work), this });
+    }
+
+    void TaskGroup::finish(std::exception_ptr failure)
+    {
+        // Decrementing under the lock keeps the group alive until wait() has
+        // seen the final count.
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failure && !error)
+        {
+            error = failure;
+        }
+        if (--pending == 0)
+        {
+            done.notify_all();
+        }
+    }
+
+    void TaskGroup::wait()
+    {
+        ThreadPool* pool = pending > 0 ? shared_pool() : nullptr;
+        while (pending > 0)
+        {
+            // Help out rather than block; only sleep briefly when every queue
+            // is empty and the remaining tasks are running elsewhere.
+            if (!pool->run_one())
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait_for(lock, std::chrono::microseconds(100), [this] { return pending == 0; });
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error)
+        {
+            std::exception_ptr failure = error;
+            error = nullptr;
+            std::rethrow_exception(failure);
+        }
+    }
+
+    bool worth_parallel(std::size_t n)
+    {
+        return n >= BigInteger::thresholds().parallel && BigInteger::thread_count() > 1;
+    }
+
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain,
+                      const std::function<void(std::size_t, std::size_t)>& body)
+    {
+        const std::size_t threads = BigInteger::thread_count();
+        const std::size_t length = end - begin;
+        grain = std::max<std::size_t>(grain, 1);
+        if (threads <= 1 || length <= grain)
+        {
+            body(begin, end);
+            return;
+        }
+        // A few chunks per thread so stealing can even out the load
+        const std::size_t chunks = std::min((length + grain - 1) / grain, 4 * threads);
+        const std::size_t step = (length + chunks - 1) / chunks;
+        TaskGroup group;
+        for (std::size_t start = begin + step; start < end; start += step)
+        {
+            std::size_t stop = std::min(start + step, end);
+            group.run([&body, start, stop] { body(start, stop); });
+        }
+        body(begin, std::min(begin + step, end));
+        group.wait();
+    }
+}
+
+void BigInteger::set_thread_count(std::size_t count)
+{
+    bigint_detail::PoolState& state = bigint_detail::pool_state();
+    std::unique_ptr<bigint_detail::ThreadPool> retired;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.threads = std::max<std::size_t>(count, 1);
+        retired = std::move(state.pool);
+    }
+    // Joined outside the lock
+}
+
+std::size_t BigInteger::thread_count()
+{
+    bigint_detail::PoolState& state = bigint_detail::pool_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.threads;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "BigInteger.h"
+
+// Binary encoding of a BigInteger: a 16-byte header followed by the
+// magnitude as little-endian 64-bit limbs, least significant first.
+//
+//     offset 0   "BIGI"
+//     offset 4   version (1)
+//     offset 5   flags: bit 0 set for a negative value
+//     offset 6   two zero bytes
+//     offset 8   limb count n, 64-bit little-endian; zero for zero
+//     offset 16  n limbs, the last one nonzero
+//
+// Records are a multiple of 8 bytes long, so a file of back-to-back records
+// keeps every limb array 8-byte aligned, and on little-endian machines
+// BigIntegerView can work on the limbs in place, e.g. in a memory-mapped
+// file.
+
+const std::size_t BIGINTEGER_HEADER_SIZE = 16;
+const std::uint8_t BIGINTEGER_FORMAT_VERSION = 1;
+
+// Bytes serialize() writes for value
+std::size_t serialized_size(const BigInteger& value);
+
+// Writes value into [first, last) and returns one past the last byte
+// written, or nullptr if it does not fit.
+unsigned char* serialize(const BigInteger& value, unsigned char* first, unsigned char* last);
+
+// Reads the record at first and advances first past it. Throws
+// std::invalid_argument for a bad header, an unknown version, a
+// non-canonical value or a record running past last.
+BigInteger deserialize(const unsigned char*& first, const unsigned char* last);
+
+// Non-owning, read-only view of a BigInteger's limbs, either those of a live
+// BigInteger or of a serialized record. The viewed memory must outlive the
+// view. Comparisons and arithmetic work on the limbs directly; results of
+// arithmetic are ordinary BigIntegers.
+class BigIntegerView
+{
+    public:
+        BigIntegerView(const BigInteger& value);
+
+        // Views the record at first without copying and advances first past
+        // it. Validates as deserialize() and also throws if the limbs are not
+        // 8-byte aligned or the machine is not little-endian.
+        static BigIntegerView read(const unsigned char*& first, const unsigned char* last);
+
+        // Little-endian limbs; a zero value has one zero limb.
+        constexpr const std::uint64_t* data() const { return limbs; }
+        constexpr std::size_t size() const { return count; }
+
+        constexpr bool is_negative() const { return negative; }
+        constexpr bool is_positive() const { return !negative && (count > 1 || limbs[0] != 0); }
+
+        // A BigInteger holding a copy of the viewed value
+        BigInteger to_big_integer() const;
+        std::string to_string() const;
+
+        // -1, 0 or 1 as a is less than, equal to or greater than b
+        friend int compare(BigIntegerView a, BigIntegerView b);
+
+        friend BigInteger operator+(BigIntegerView a, BigIntegerView b);
+        friend BigInteger operator-(BigIntegerView a, BigIntegerView b);
+        friend BigInteger operator*(BigIntegerView a, BigIntegerView b);
+        // Truncating division, as BigInteger
+        friend BigInteger operator/(BigIntegerView a, BigIntegerView b);
+        friend BigInteger operator%(BigIntegerView a, BigIntegerView b);
+
+        // The same limbs with the opposite sign; zero stays zero
+        friend constexpr BigIntegerView operator-(BigIntegerView value)
+        {
+            return BigIntegerView(value.limbs, value.count, value.is_positive());
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, BigIntegerView value);
+        friend BigInteger deserialize(const unsigned char*& first, const unsigned char* last);
+        template<char... Digits>
+        friend constexpr BigIntegerView operator""_big();
+
+    private:
+        const std::uint64_t* limbs;
+        std::size_t count;
+        bool negative;
+
+        constexpr BigIntegerView(const std::uint64_t* limbs, std::size_t count, bool negative)
+            : limbs(limbs), count(count), negative(negative)
+        {
+        }
+
+        // For the friends above, which build results straight into a
+        // BigInteger's limbs; finish() sets the sign and strips high zeros.
+        static LimbVector& magnitude(BigInteger& value);
+        static void finish(BigInteger& value, bool negative);
+};
+
+inline bool operator==(BigIntegerView a, BigIntegerView b)
+{
+    return compare(a, b) == 0;
+}
+
+inline bool operator!=(BigIntegerView a, BigIntegerView b)
+{
+    return compare(a, b) != 0;
+}
+
+inline bool operator<(BigIntegerView a, BigIntegerView b)
+{
+    return compare(a, b) < 0;
+}
+
+inline bool operator<=(BigIntegerView a, BigIntegerView b)
+{
+    return compare(a, b) <= 0;
+}
+
+inline bool operator>(BigIntegerView a, BigIntegerView b)
+{
+    return compare(a, b) > 0;
+}
+
+inline bool operator>=(BigIntegerView a, BigIntegerView b)
+{
+    return compare(a, b) >= 0;
+}
@@ -0,0 +1,715 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "BigInteger.h"
+
+// Signed integer of a fixed Bits bits (a multiple of 64) in two's
+// complement, for work at one known size such as 256-bit or 4096-bit
+// arithmetic:
+//
+//     typedef FixedBigInteger<512> Int512;
+//     constexpr Int512 p("57896044618658097711785492504343953926634992332820282019728792003956564819949");
+//     Int512 x = a * b % p; // a, b in [0, p): the product needs 510 bits
+//
+// The limbs live in a std::array inside the object, so nothing is ever
+// allocated and there is no length to maintain. Loops run over the limb count,
+// a compile-time constant the compiler unrolls, and all arithmetic is
+// constexpr. Within [min(), max()] values behave exactly as BigInteger does,
+// division truncating toward zero and the bitwise operators and >> working
+// on the two's-complement form. Outside it, Overflow decides (see
+// FixedBigIntegerOverflow in BigInteger.h); an overflowing checked operation
+// in a constant expression fails to compile.
+template<std::size_t Bits, FixedBigIntegerOverflow Overflow = FixedBigIntegerOverflow::checked>
+class FixedBigInteger
+{
+    static_assert(Bits > 0 && Bits % 64 == 0, "FixedBigInteger needs a positive multiple of 64 bits");
+
+    public:
+        static constexpr std::size_t LIMBS = Bits / 64;
+
+        constexpr FixedBigInteger() : number{}
+        {
+        }
+
+        template<typename T, typename = typename std::enable_if_t<std::is_integral<T>::value>>
+        constexpr FixedBigInteger(const T num) : number{}
+        {
+            number[0] = static_cast<std::uint64_t>(num);
+            if constexpr (std::is_signed<T>::value)
+            {
+                for (std::size_t i = 1; i < LIMBS; i++)
+                {
+                    number[i] = num < 0 ? ~static_cast<std::uint64_t>(0) : 0;
+                }
+            }
+            else
+            {
+                check(LIMBS == 1 && number[0] >> 63);
+            }
+        }
+
+        // Decimal digits after an optional '-'; throws std::invalid_argument
+        // for anything else.
+        constexpr explicit FixedBigInteger(std::string_view digits) : number{}
+        {
+            const bool minus = !digits.empty() && digits[0] == '-';
+            const std::size_t first = minus ? 1 : 0;
+            if (digits.size() == first)
+            {
+                throw std::invalid_argument("Cannot assign non-numeric string to FixedBigInteger");
+            }
+            // Nineteen digits at a time: magnitude = magnitude * 10^k + chunk
+            Limbs magnitude{};
+            bool carried = false;
+            for (std::size_t i = first; i < digits.size();)
+            {
+                std::uint64_t chunk = 0;
+                std::uint64_t scale = 1;
+                for (std::size_t k = 0; k < 19 && i < digits.size(); k++, i++)
+                {
+                    if (digits[i] < '0' || digits[i] > '9')
+                    {
+                        throw std::invalid_argument("Cannot assign non-numeric string to FixedBigInteger");
+                    }
+                    chunk = chunk * 10 + static_cast<std::uint64_t>(digits[i] - '0');
+                    scale *= 10;
+                }
+                std::uint64_t carry = chunk;
+                for (std::size_t j = 0; j < LIMBS; j++)
+                {
+                    const Wide t = static_cast<Wide>(magnitude[j]) * scale + carry;
+                    magnitude[j] = static_cast<std::uint64_t>(t);
+                    carry = static_cast<std::uint64_t>(t >> 64);
+                }
+                carried = carried || carry != 0;
+            }
+            number = from_magnitude(magnitude, minus, carried).number;
+        }
+
+        constexpr explicit FixedBigInteger(const char* digits) : FixedBigInteger(std::string_view(digits))
+        {
+        }
+
+        explicit FixedBigInteger(const std::string& digits) : FixedBigInteger(std::string_view(digits))
+        {
+        }
+
+        // Throws std::invalid_argument if value is outside [min(), max()] in
+        // checked mode; wrapping keeps value modulo 2^Bits.
+        explicit FixedBigInteger(const BigInteger& value) : number{}
+        {
+            if (value.number.empty())
+            {
+                throw std::invalid_argument("Cannot convert uninitialized BigInteger");
+            }
+            const std::size_t n = value.number.size();
+            Limbs magnitude{};
+            for (std::size_t i = 0; i < LIMBS && i < n; i++)
+            {
+                magnitude[i] = value.number[i];
+            }
+            number = from_magnitude(magnitude, value.negative, n > LIMBS).number;
+        }
+
+        BigInteger to_big_integer() const
+        {
+            const Limbs magnitude = magnitude_of(*this);
+            BigInteger result(0);
+            result.number.assign(magnitude.data(), magnitude.data() + LIMBS);
+            result.negative = is_negative();
+            result.normalize();
+            return result;
+        }
+
+        std::string to_string() const
+        {
+            // Nineteen-digit chunks, least significant first
+            Limbs magnitude = magnitude_of(*this);
+            std::array<std::uint64_t, (Bits + 62) / 63> chunks{};
+            std::size_t count = 0;
+            do
+            {
+                chunks[count++] = divrem_1(magnitude, TEN_TO_19);
+            } while (significant(magnitude) != 0);
+
+            std::string digits = is_negative() ? "-" : "";
+            digits += std::to_string(chunks[count - 1]);
+            for (std::size_t i = count - 1; i-- > 0;)
+            {
+                std::string chunk = std::to_string(chunks[i]);
+                digits.append(19 - chunk.size(), '0');
+                digits += chunk;
+            }
+            return digits;
+        }
+
+        // -2^(Bits-1) and 2^(Bits-1) - 1
+        static constexpr FixedBigInteger min()
+        {
+            FixedBigInteger result;
+            result.number[LIMBS - 1] = static_cast<std::uint64_t>(1) << 63;
+            return result;
+        }
+
+        static constexpr FixedBigInteger max()
+        {
+            return ~min();
+        }
+
+        // Two's-complement limbs, least significant first
+        constexpr const std::uint64_t* data() const
+        {
+            return number.data();
+        }
+
+        static constexpr std::size_t size()
+        {
+            return LIMBS;
+        }
+
+        constexpr bool is_negative() const
+        {
+            return (number[LIMBS - 1] >> 63) != 0;
+        }
+
+        constexpr bool is_positive() const
+        {
+            return !is_negative() && significant(number) != 0;
+        }
+
+        constexpr FixedBigInteger& operator+=(const FixedBigInteger& other)
+        {
+            const bool a = is_negative();
+            const bool b = other.is_negative();
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                const Wide sum = static_cast<Wide>(number[i]) + other.number[i] + carry;
+                number[i] = static_cast<std::uint64_t>(sum);
+                carry = static_cast<std::uint64_t>(sum >> 64);
+            }
+            check(a == b && is_negative() != a);
+            return *this;
+        }
+
+        constexpr FixedBigInteger& operator-=(const FixedBigInteger& other)
+        {
+            const bool a = is_negative();
+            const bool b = other.is_negative();
+            std::uint64_t borrow = 0;
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                const Wide difference = static_cast<Wide>(number[i]) - other.number[i] - borrow;
+                number[i] = static_cast<std::uint64_t>(difference);
+                borrow = static_cast<std::uint64_t>(difference >> 64) & 1;
+            }
+            check(a != b && is_negative() != a);
+            return *this;
+        }
+
+        constexpr FixedBigInteger& operator*=(const FixedBigInteger& other)
+        {
+            return *this = *this * other;
+        }
+
+        constexpr FixedBigInteger& operator/=(const FixedBigInteger& other)
+        {
+            return *this = *this / other;
+        }
+
+        constexpr FixedBigInteger& operator%=(const FixedBigInteger& other)
+        {
+            return *this = *this % other;
+        }
+
+        constexpr FixedBigInteger& operator<<=(std::size_t bits)
+        {
+            const FixedBigInteger original = *this;
+            const std::size_t limbs = bits / 64;
+            const unsigned shift = static_cast<unsigned>(bits % 64);
+            for (std::size_t i = LIMBS; i-- > 0;)
+            {
+                std::uint64_t limb = 0;
+                if (i >= limbs && bits < Bits)
+                {
+                    limb = number[i - limbs] << shift;
+                    if (shift != 0 && i > limbs)
+                    {
+                        limb |= number[i - limbs - 1] >> (64 - shift);
+                    }
+                }
+                number[i] = limb;
+            }
+            // Fits when shifting back gives the original value
+            check(Overflow == FixedBigIntegerOverflow::checked && (*this >> bits) != original);
+            return *this;
+        }
+
+        constexpr FixedBigInteger& operator>>=(std::size_t bits)
+        {
+            const std::uint64_t fill = is_negative() ? ~static_cast<std::uint64_t>(0) : 0;
+            const std::size_t limbs = bits / 64;
+            const unsigned shift = static_cast<unsigned>(bits % 64);
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                const std::uint64_t low = bits < Bits && i + limbs < LIMBS ? number[i + limbs] : fill;
+                const std::uint64_t high = bits < Bits && i + limbs + 1 < LIMBS ? number[i + limbs + 1] : fill;
+                number[i] = shift == 0 ? low : (low >> shift) | (high << (64 - shift));
+            }
+            return *this;
+        }
+
+        constexpr FixedBigInteger& operator&=(const FixedBigInteger& other)
+        {
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                number[i] &= other.number[i];
+            }
+            return *this;
+        }
+
+        constexpr FixedBigInteger& operator|=(const FixedBigInteger& other)
+        {
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                number[i] |= other.number[i];
+            }
+            return *this;
+        }
+
+        constexpr FixedBigInteger& operator^=(const FixedBigInteger& other)
+        {
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                number[i] ^= other.number[i];
+            }
+            return *this;
+        }
+
+        constexpr FixedBigInteger operator-() const
+        {
+            FixedBigInteger result = *this;
+            negate(result.number);
+            check(is_negative() && result.is_negative());
+            return result;
+        }
+
+        constexpr FixedBigInteger operator~() const
+        {
+            FixedBigInteger result;
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                result.number[i] = ~number[i];
+            }
+            return result;
+        }
+
+        constexpr FixedBigInteger operator+(const FixedBigInteger& other) const
+        {
+            FixedBigInteger result = *this;
+            return result += other;
+        }
+
+        constexpr FixedBigInteger operator-(const FixedBigInteger& other) const
+        {
+            FixedBigInteger result = *this;
+            return result -= other;
+        }
+
+        // Products of the magnitudes, keeping only limbs below Bits. The
+        // result fits unless a dropped partial product or a row's final carry
+        // is nonzero, or the top bit is left set.
+        constexpr FixedBigInteger operator*(const FixedBigInteger& other) const
+        {
+            const Limbs x = magnitude_of(*this);
+            const Limbs y = magnitude_of(other);
+            const std::size_t xn = significant(x);
+            const std::size_t yn = significant(y);
+            bool carried = xn != 0 && yn != 0 && xn + yn - 2 >= LIMBS;
+            Limbs product{};
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                if (x[i] == 0)
+                {
+                    continue;
+                }
+                std::uint64_t carry = 0;
+                for (std::size_t j = 0; i + j < LIMBS; j++)
+                {
+                    const Wide t = static_cast<Wide>(x[i]) * y[j] + product[i + j] + carry;
+                    product[i + j] = static_cast<std::uint64_t>(t);
+                    carry = static_cast<std::uint64_t>(t >> 64);
+                }
+                carried = carried || carry != 0;
+            }
+            return from_magnitude(product, is_negative() != other.is_negative(), carried);
+        }
+
+        // Truncating division, as BigInteger: the remainder takes the
+        // dividend's sign. Only min() / -1 overflows.
+        constexpr FixedBigInteger operator/(const FixedBigInteger& other) const
+        {
+            Limbs quotient{};
+            Limbs remainder{};
+            divide(magnitude_of(*this), magnitude_of(other), quotient, remainder);
+            return from_magnitude(quotient, is_negative() != other.is_negative(), false);
+        }
+
+        constexpr FixedBigInteger operator%(const FixedBigInteger& other) const
+        {
+            Limbs quotient{};
+            Limbs remainder{};
+            divide(magnitude_of(*this), magnitude_of(other), quotient, remainder);
+            return from_magnitude(remainder, is_negative(), false);
+        }
+
+        constexpr FixedBigInteger operator<<(std::size_t bits) const
+        {
+            FixedBigInteger result = *this;
+            return result <<= bits;
+        }
+
+        constexpr FixedBigInteger operator>>(std::size_t bits) const
+        {
+            FixedBigInteger result = *this;
+            return result >>= bits;
+        }
+
+        constexpr FixedBigInteger operator&(const FixedBigInteger& other) const
+        {
+            FixedBigInteger result = *this;
+            return result &= other;
+        }
+
+        constexpr FixedBigInteger operator|(const FixedBigInteger& other) const
+        {
+            FixedBigInteger result = *this;
+            return result |= other;
+        }
+
+        constexpr FixedBigInteger operator^(const FixedBigInteger& other) const
+        {
+            FixedBigInteger result = *this;
+            return result ^= other;
+        }
+
+        // -1, 0 or 1 as a is less than, equal to or greater than b
+        friend constexpr int compare(const FixedBigInteger& a, const FixedBigInteger& b)
+        {
+            if (a.is_negative() != b.is_negative())
+            {
+                return a.is_negative() ? -1 : 1;
+            }
+            for (std::size_t i = LIMBS; i-- > 0;)
+            {
+                if (a.number[i] != b.number[i])
+                {
+                    return a.number[i] < b.number[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        constexpr bool operator==(const FixedBigInteger& other) const
+        {
+            return compare(*this, other) == 0;
+        }
+
+        constexpr bool operator!=(const FixedBigInteger& other) const
+        {
+            return compare(*this, other) != 0;
+        }
+
+        constexpr bool operator<(const FixedBigInteger& other) const
+        {
+            return compare(*this, other) < 0;
+        }
+
+        constexpr bool operator<=(const FixedBigInteger& other) const
+        {
+            return compare(*this, other) <= 0;
+        }
+
+        constexpr bool operator>(const FixedBigInteger& other) const
+        {
+            return compare(*this, other) > 0;
+        }
+
+        constexpr bool operator>=(const FixedBigInteger& other) const
+        {
+            return compare(*this, other) >= 0;
+        }
+
+        // As BigInteger: bits, set bits and bit index of the two's-complement
+        // form, a negative value counting its clear bits.
+        constexpr std::size_t bit_length() const
+        {
+            const std::uint64_t flip = is_negative() ? ~static_cast<std::uint64_t>(0) : 0;
+            for (std::size_t i = LIMBS; i-- > 0;)
+            {
+                if ((number[i] ^ flip) != 0)
+                {
+                    return 64 * i + 64 - static_cast<std::size_t>(__builtin_clzll(number[i] ^ flip));
+                }
+            }
+            return 0;
+        }
+
+        constexpr std::size_t popcount() const
+        {
+            const std::uint64_t flip = is_negative() ? ~static_cast<std::uint64_t>(0) : 0;
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                count += static_cast<std::size_t>(__builtin_popcountll(number[i] ^ flip));
+            }
+            return count;
+        }
+
+        constexpr bool test_bit(std::size_t index) const
+        {
+            return index >= Bits ? is_negative() : ((number[index / 64] >> (index % 64)) & 1) != 0;
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const FixedBigInteger& value)
+        {
+            return os << value.to_string();
+        }
+
+        // Reads a BigInteger and converts it, so an out-of-range value throws
+        // in checked mode.
+        friend std::istream& operator>>(std::istream& is, FixedBigInteger& value)
+        {
+            BigInteger parsed;
+            if (is >> parsed)
+            {
+                value = FixedBigInteger(parsed);
+            }
+            return is;
+        }
+
+    private:
+        typedef unsigned __int128 Wide;
+        typedef std::array<std::uint64_t, LIMBS> Limbs;
+
+        static constexpr std::uint64_t TEN_TO_19 = 10000000000000000000ULL;
+
+        Limbs number;
+
+        static constexpr void check(bool overflowed)
+        {
+            if (Overflow == FixedBigIntegerOverflow::checked && overflowed)
+            {
+                throw std::invalid_argument("Cannot fit result in FixedBigInteger");
+            }
+        }
+
+        // Limbs up to the most significant nonzero one
+        static constexpr std::size_t significant(const Limbs& a)
+        {
+            std::size_t n = LIMBS;
+            while (n > 0 && a[n - 1] == 0)
+            {
+                n--;
+            }
+            return n;
+        }
+
+        static constexpr void negate(Limbs& a)
+        {
+            std::uint64_t carry = 1;
+            for (std::size_t i = 0; i < LIMBS; i++)
+            {
+                a[i] = ~a[i] + carry;
+                carry = carry && a[i] == 0;
+            }
+        }
+
+        // |value| as an unsigned Bits-bit number, which holds even |min()|
+        static constexpr Limbs magnitude_of(const FixedBigInteger& value)
+        {
+            Limbs magnitude = value.number;
+            if (value.is_negative())
+            {
+                negate(magnitude);
+            }
+            return magnitude;
+        }
+
+        // The value with the given sign and magnitude, where carried says the
+        // magnitude already lost bits above Bits.
+        static constexpr FixedBigInteger from_magnitude(const Limbs& magnitude, bool negative, bool carried)
+        {
+            FixedBigInteger result;
+            result.number = magnitude;
+            if (negative)
+            {
+                negate(result.number);
+            }
+            // A magnitude with the top bit set only fits as |min()|, which is
+            // its own negation
+            const bool top = (magnitude[LIMBS - 1] >> 63) != 0;
+            check(carried || (top && !(negative && result == min())));
+            return result;
+        }
+
+        // (high, low) / d for high < d, storing the remainder. Outside
+        // constant evaluation this is a single divq rather than a call to the
+        // 128-bit division routine.
+        static constexpr std::uint64_t div_2by1(std::uint64_t high, std::uint64_t low, std::uint64_t d, std::uint64_t& remainder)
+        {
+#if defined(__x86_64__)
+            if (!__builtin_is_constant_evaluated())
+            {
+                return divq(high, low, d, remainder);
+            }
+#endif
+            const Wide numerator = (static_cast<Wide>(high) << 64) | low;
+            remainder = static_cast<std::uint64_t>(numerator % d);
+            return static_cast<std::uint64_t>(numerator / d);
+        }
+
+#if defined(__x86_64__)
+        static std::uint64_t divq(std::uint64_t high, std::uint64_t low, std::uint64_t d, std::uint64_t& remainder)
+        {
+            std::uint64_t quotient;
+            __asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(low), "d"(high), "rm"(d));
+            return quotient;
+        }
+#endif
+
+        // a /= d, returning the remainder
+        static constexpr std::uint64_t divrem_1(Limbs& a, std::uint64_t d)
+        {
+            std::uint64_t remainder = 0;
+            for (std::size_t i = LIMBS; i-- > 0;)
+            {
+                a[i] = div_2by1(remainder, a[i], d, remainder);
+            }
+            return remainder;
+        }
+
+        // Knuth's Algorithm D on magnitudes
+        static constexpr void divide(const Limbs& u, const Limbs& v, Limbs& quotient, Limbs& remainder)
+        {
+            const std::size_t vn = significant(v);
+            const std::size_t un = significant(u);
+            if (vn == 0)
+            {
+                throw std::invalid_argument("Cannot divide FixedBigInteger by zero");
+            }
+            if (un < vn)
+            {
+                remainder = u;
+                return;
+            }
+            if (vn == 1)
+            {
+                quotient = u;
+                remainder[0] = divrem_1(quotient, v[0]);
+                return;
+            }
+
+            // Normalize so the divisor's top bit is set
+            const unsigned shift = static_cast<unsigned>(__builtin_clzll(v[vn - 1]));
+            std::array<std::uint64_t, LIMBS + 1> w{};
+            Limbs d{};
+            for (std::size_t i = 0; i < vn; i++)
+            {
+                d[i] = v[i] << shift | (shift != 0 && i > 0 ? v[i - 1] >> (64 - shift) : 0);
+            }
+            for (std::size_t i = 0; i <= un; i++)
+            {
+                const std::uint64_t low = i > 0 && shift != 0 ? u[i - 1] >> (64 - shift) : 0;
+                w[i] = (i < un ? u[i] << shift : 0) | low;
+            }
+
+            const std::uint64_t top = d[vn - 1];
+            for (std::size_t j = un - vn + 1; j-- > 0;)
+            {
+                // Estimate from the top two limbs, at most one too large after
+                // checking against the next divisor limb
+                Wide estimate = 0;
+                Wide rest = 0;
+                if (w[j + vn] < top)
+                {
+                    std::uint64_t r = 0;
+                    estimate = div_2by1(w[j + vn], w[j + vn - 1], top, r);
+                    rest = r;
+                }
+                else
+                {
+                    const Wide numerator = (static_cast<Wide>(w[j + vn]) << 64) | w[j + vn - 1];
+                    estimate = numerator / top;
+                    rest = numerator % top;
+                }
+                while ((estimate >> 64) != 0 || estimate * d[vn - 2] > ((rest << 64) | w[j + vn - 2]))
+                {
+                    estimate--;
+                    rest += top;
+                    if ((rest >> 64) != 0)
+                    {
+                        break;
+                    }
+                }
+
+                std::uint64_t carry = 0;
+                std::uint64_t borrow = 0;
+                for (std::size_t i = 0; i < vn; i++)
+                {
+                    const Wide product = estimate * d[i] + carry;
+                    carry = static_cast<std::uint64_t>(product >> 64);
+                    const Wide difference = static_cast<Wide>(w[i + j]) - static_cast<std::uint64_t>(product) - borrow;
+                    w[i + j] = static_cast<std::uint64_t>(difference);
+                    borrow = static_cast<std::uint64_t>(difference >> 64) & 1;
+                }
+                const Wide difference = static_cast<Wide>(w[j + vn]) - carry - borrow;
+                w[j + vn] = static_cast<std::uint64_t>(difference);
+                if ((difference >> 64) != 0)
+                {
+                    // Went below zero: add one divisor back
+                    estimate--;
+                    std::uint64_t back = 0;
+                    for (std::size_t i = 0; i < vn; i++)
+                    {
+                        const Wide sum = static_cast<Wide>(w[i + j]) + d[i] + back;
+                        w[i + j] = static_cast<std::uint64_t>(sum);
+                        back = static_cast<std::uint64_t>(sum >> 64);
+                    }
+                    w[j + vn] += back;
+                }
+                quotient[j] = static_cast<std::uint64_t>(estimate);
+            }
+            for (std::size_t i = 0; i < vn; i++)
+            {
+                remainder[i] = w[i] >> shift | (shift != 0 ? w[i + 1] << (64 - shift) : 0);
+            }
+        }
+};
+
+namespace std
+{
+    template<std::size_t Bits, FixedBigIntegerOverflow Overflow>
+    struct hash<FixedBigInteger<Bits, Overflow>>
+    {
+        std::size_t operator()(const FixedBigInteger<Bits, Overflow>& value) const
+        {
+            // Folded 128-bit products, one limb per step
+            std::uint64_t h = 0xa0761d6478bd642full;
+            for (std::size_t i = 0; i < value.size(); i++)
+            {
+                const unsigned __int128 product = static_cast<unsigned __int128>(value.data()[i] ^ h) * 0xe7037ed1a0b428dbull;
+                h = static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+            }
+            return static_cast<std::size_t>(h);
+        }
+    };
+}
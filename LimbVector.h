@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include "BigIntegerStats.h"
+
+// Little-endian limb storage for BigInteger. Up to two limbs (128 bits) are
+// kept inline in the object, so small values never touch the heap; larger
+// magnitudes spill to a heap block that grows geometrically. Heap blocks come
+// from a std::pmr::memory_resource; as with the std::pmr containers, copies
+// start on the default resource, moves carry the resource along, and
+// assignment keeps the target's resource.
+class LimbVector
+{
+    public:
+        typedef std::uint64_t value_type;
+        static const std::size_t INLINE_CAPACITY = 2;
+
+        LimbVector() noexcept
+            : LimbVector(std::pmr::get_default_resource())
+        {
+        }
+
+        explicit LimbVector(std::pmr::memory_resource* resource) noexcept
+            : length(0), allocated(INLINE_CAPACITY), resource(resource)
+        {
+        }
+
+        explicit LimbVector(std::size_t count, value_type value = 0)
+            : LimbVector()
+        {
+            assign(count, value);
+        }
+
+        LimbVector(const value_type* first, const value_type* last)
+            : LimbVector()
+        {
+            assign(first, last);
+        }
+
+        LimbVector(const LimbVector& other)
+            : LimbVector()
+        {
+            assign(other.begin(), other.end());
+        }
+
+        LimbVector(LimbVector&& other) noexcept
+            : LimbVector(other.resource)
+        {
+            take(other);
+        }
+
+        ~LimbVector()
+        {
+            release();
+        }
+
+        LimbVector& operator=(const LimbVector& other)
+        {
+            if (this != &other)
+            {
+                assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        // Copies instead of stealing when the resources differ, so this can
+        // allocate and throw.
+        LimbVector& operator=(LimbVector&& other)
+        {
+            if (this == &other)
+            {
+                return *this;
+            }
+            if (other.is_inline() || *resource == *other.resource)
+            {
+                release();
+                take(other);
+            }
+            else
+            {
+                assign(other.begin(), other.end());
+                other.clear();
+            }
+            return *this;
+        }
+
+        std::size_t size() const { return length; }
+        std::size_t capacity() const { return allocated; }
+        bool empty() const { return length == 0; }
+        bool is_inline() const { return allocated == INLINE_CAPACITY; }
+        std::pmr::memory_resource* get_memory_resource() const { return resource; }
+
+        value_type* data() { return is_inline() ? local : heap; }
+        const value_type* data() const { return is_inline() ? local : heap; }
+        value_type* begin() { return data(); }
+        value_type* end() { return data() + length; }
+        const value_type* begin() const { return data(); }
+        const value_type* end() const { return data() + length; }
+
+        value_type& operator[](std::size_t i) { return data()[i]; }
+        const value_type& operator[](std::size_t i) const { return data()[i]; }
+        value_type& back() { return data()[length - 1]; }
+        const value_type& back() const { return data()[length - 1]; }
+
+        void reserve(std::size_t count)
+        {
+            if (count > allocated)
+            {
+                grow(count);
+            }
+        }
+
+        // New limbs are zero.
+        void resize(std::size_t count)
+        {
+            reserve(count);
+            if (count > length)
+            {
+                std::fill(data() + length, data() + count, 0);
+            }
+            length = count;
+        }
+
+        void assign(std::size_t count, value_type value)
+        {
+            length = 0;
+            reserve(count);
+            std::fill(data(), data() + count, value);
+            length = count;
+        }
+
+        void assign(const value_type* first, const value_type* last)
+        {
+            std::size_t count = static_cast<std::size_t>(last - first);
+            length = 0;
+            reserve(count);
+            std::copy(first, last, data());
+            length = count;
+        }
+
+        void push_back(value_type value)
+        {
+            reserve(length + 1);
+            data()[length++] = value;
+        }
+
+        void pop_back()
+        {
+            length--;
+        }
+
+        void clear()
+        {
+            length = 0;
+        }
+
+        void swap(LimbVector& other)
+        {
+            LimbVector held(std::move(other));
+            other = std::move(*this);
+            *this = std::move(held);
+        }
+
+        bool operator==(const LimbVector& other) const
+        {
+            return length == other.length && std::equal(begin(), end(), other.begin());
+        }
+
+        bool operator!=(const LimbVector& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        std::size_t length;
+        std::size_t allocated;
+        std::pmr::memory_resource* resource;
+        union
+        {
+            value_type local[INLINE_CAPACITY];
+            value_type* heap;
+        };
+
+        void grow(std::size_t minimum)
+        {
+            std::size_t target = std::max(minimum, 2 * allocated);
+            value_type* block = static_cast<value_type*>(resource->allocate(target * sizeof(value_type), alignof(value_type)));
+            bigint_detail::record_allocation(target * sizeof(value_type));
+            std::copy(begin(), end(), block);
+            release();
+            heap = block;
+            allocated = target;
+        }
+
+        void release()
+        {
+            if (!is_inline())
+            {
+                resource->deallocate(heap, allocated * sizeof(value_type), alignof(value_type));
+                bigint_detail::record_deallocation(allocated * sizeof(value_type));
+                allocated = INLINE_CAPACITY;
+            }
+        }
+
+        // Moves other's contents into this empty inline vector. A heap block is
+        // only taken over from a vector on an equal resource.
+        void take(LimbVector& other)
+        {
+            length = other.length;
+            if (other.is_inline())
+            {
+                std::copy(other.local, other.local + other.length, local);
+            }
+            else
+            {
+                heap = other.heap;
+                allocated = other.allocated;
+                other.allocated = INLINE_CAPACITY;
+            }
+            other.length = 0;
+        }
+};